@@ -0,0 +1,343 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+
+/*****************************************************************************
+* Parcel throughput benchmark. For each combination of node count, port      *
+* speed and parcel size, boots a simulated bus on the virtual clock, then    *
+* streams parcels from the first node to the second for a fixed period,      *
+* while the remaining nodes pass the token.                                  *
+*                                                                            *
+* goodput     parcel payload delivered to the receiving application / sec.   *
+* wire eff.   payload bytes delivered / bytes driven onto the wire.          *
+* line util.  goodput as a share of the raw line rate.                       *
+* ack rtt     from ezbus_socket_send() to the acknowledgement, ms.           *
+* pool tx/rx  most parcel buffers in use at once, sender / receiver.         *
+*                                                                            *
+* Sizes above EZBUS_PARCEL_DATA_LN are sent as chained messages, each is     *
+* checked on arrival and the row is flagged CORRUPT on any mismatch.         *
+* With -z, sizes that fit one parcel are written in place through            *
+* ezbus_socket_reserve() and ezbus_socket_commit(), and received bytes are   *
+* checked in place through ezbus_socket_borrow() and ezbus_socket_release(). *
+*                                                                            *
+* usage: ezbus_bench [-n nodes,..] [-s speed,..] [-p size,..] [-t seconds]   *
+*                    [-z]                                                    *
+*****************************************************************************/
+
+#include <ezbus.h>
+#include <ezbus_mac.h>
+#include <ezbus_mac_peers.h>
+#include <ezbus_mac_arbiter.h>
+#include <ezbus_socket.h>
+#include <ezbus_platform.h>
+#include <ezbus_sim_bus.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define EZBUS_BENCH_MAX_POINTS      16
+#define EZBUS_BENCH_BOOT_TIMEOUT    60              /* seconds of virtual time to wait for boot */
+#define EZBUS_BENCH_MAX_MESSAGE     (64*1024)       /* larger than a parcel is sent as a chain */
+
+typedef struct
+{
+    bool            booted;
+    uint64_t        payload_bytes;                  /* delivered to the receiving application */
+    uint64_t        wire_bytes;
+    uint32_t        parcels;
+    uint32_t        corrupt;                        /* messages not received intact */
+    double          rtt_sum_ms;
+    double          rtt_max_ms;
+    uint16_t        pool_tx;                        /* buffer pool high-water marks */
+    uint16_t        pool_rx;
+} ezbus_bench_result_t;
+
+static ezbus_sim_bus_t  bench_bus;
+static ezbus_port_t     bench_ports[ EZBUS_SIM_MAX_PORTS ];
+static ezbus_t          bench_nodes[ EZBUS_SIM_MAX_PORTS ];
+static uint8_t          bench_payload[ EZBUS_BENCH_MAX_MESSAGE ];
+static uint8_t          bench_scratch[ EZBUS_BENCH_MAX_MESSAGE ];
+
+static ezbus_socket_t   bench_tx_socket = EZBUS_SOCKET_INVALID;
+static size_t           bench_parcel_size;
+static ezbus_sim_ns_t   bench_sent_ns[ 256 ];      /* send time by sequence number */
+static uint64_t         bench_rx_bytes;
+static size_t           bench_tx_offset;            /* progress through a chained message */
+static size_t           bench_rx_offset;
+static uint32_t         bench_rx_corrupt;
+static bool             bench_zero_copy;            /* reserve and commit rather than send */
+
+static bool ezbus_bench_socket_send ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    if ( socket != EZBUS_SOCKET_INVALID && socket == bench_tx_socket && mac == ezbus_mac( &bench_nodes[0] ) )
+    {
+        uint8_t seq = ezbus_socket_get_tx_seq( mac, socket );
+        int sent = 0;
+        if ( bench_zero_copy && bench_parcel_size <= EZBUS_PARCEL_DATA_LN )
+        {
+            void* parcel = ezbus_socket_reserve( mac, socket, NULL );
+            if ( parcel != NULL )
+            {
+                memcpy( parcel, bench_payload, bench_parcel_size );
+                sent = ezbus_socket_commit( mac, socket, bench_parcel_size );
+            }
+        }
+        else
+        {
+            sent = ezbus_socket_send( mac, socket, &bench_payload[ bench_tx_offset ], bench_parcel_size - bench_tx_offset );
+        }
+        if ( sent > 0 )
+        {
+            bench_tx_offset = ( bench_tx_offset + sent ) % bench_parcel_size;
+            while ( seq != ezbus_socket_get_tx_seq( mac, socket ) )
+            {
+                bench_sent_ns[ seq++ ] = ezbus_sim_clock_ns();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ezbus_bench_check ( const void* bytes, size_t size )
+{
+    if ( size > 0 )
+    {
+        if ( bench_rx_offset + size > bench_parcel_size || 
+             memcmp( bytes, &bench_payload[ bench_rx_offset ], size ) != 0 )
+        {
+            ++bench_rx_corrupt;
+        }
+        bench_rx_bytes  += size;
+        bench_rx_offset += size;
+    }
+}
+
+static bool ezbus_bench_socket_recv ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    if ( bench_zero_copy )
+    {
+        /* check the bytes where they lie, a message across the ring wrap is lent in two */
+        size_t size;
+        const void* bytes;
+        do
+        {
+            bytes = ezbus_socket_borrow( mac, socket, &size );
+            ezbus_bench_check( bytes, size );
+            ezbus_socket_release( mac, socket, size );
+        } while ( size && !ezbus_socket_recv_end( mac, socket ) );
+    }
+    else
+    {
+        ezbus_bench_check( bench_scratch, ezbus_socket_recv( mac, socket, bench_scratch, sizeof(bench_scratch) ) );
+    }
+    if ( ezbus_socket_recv_end( mac, socket ) )
+    {
+        if ( bench_rx_offset != bench_parcel_size )
+        {
+            ++bench_rx_corrupt;
+        }
+        bench_rx_offset = 0;
+    }
+    return true;
+}
+
+static void ezbus_bench_socket_closing ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    if ( socket == bench_tx_socket && mac == ezbus_mac( &bench_nodes[0] ) )
+    {
+        bench_tx_socket = EZBUS_SOCKET_INVALID;
+    }
+}
+
+static bool ezbus_bench_converged( int node_count )
+{
+    for( int n=0; n < node_count; n++ )
+    {
+        ezbus_mac_t* mac = ezbus_mac( &bench_nodes[n] );
+        if ( !ezbus_mac_arbiter_online( mac ) || ezbus_mac_peers_count( mac ) != node_count )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ezbus_bench_point( int node_count, uint32_t speed, size_t parcel_size, uint32_t seconds, ezbus_bench_result_t* result )
+{
+    ezbus_sim_ns_t  deadline;
+    uint8_t         ack_seq;
+    uint64_t        wire_start;
+
+    memset( result, 0, sizeof(ezbus_bench_result_t) );
+
+    ezbus_sim_clock_set_source( ezbus_sim_clock_virtual );
+    ezbus_platform_setup( NULL );
+    ezbus_sim_bus_init( &bench_bus, EZBUS_SIM_TURNAROUND_NS );
+
+    bench_tx_socket   = EZBUS_SOCKET_INVALID;
+    bench_parcel_size = parcel_size;
+    bench_rx_bytes    = 0;
+    bench_tx_offset   = 0;
+    bench_rx_offset   = 0;
+    bench_rx_corrupt  = 0;
+
+    for( int n=0; n < node_count; n++ )
+    {
+        ezbus_address_t address;
+        address.word = 0x1000 + ( n * 0x11 );
+        ezbus_sim_bus_attach( &bench_bus, &bench_ports[n], speed, &address );
+        ezbus_port_open( &bench_ports[n] );
+        ezbus_init( &bench_nodes[n], &bench_ports[n] );
+        ezbus_socket_init( ezbus_mac( &bench_nodes[n] ), ezbus_bench_socket_send, ezbus_bench_socket_recv, ezbus_bench_socket_closing, NULL );
+    }
+
+    deadline = ezbus_sim_clock_ns() + ( (ezbus_sim_ns_t)EZBUS_BENCH_BOOT_TIMEOUT * 1000000000ULL );
+    while ( !ezbus_bench_converged( node_count ) )
+    {
+        if ( ezbus_sim_clock_ns() > deadline )
+        {
+            return;
+        }
+        ezbus_sim_bus_run( &bench_bus, bench_nodes, node_count );
+    }
+    result->booted = true;
+
+    bench_tx_socket = ezbus_socket_open( ezbus_mac( &bench_nodes[0] ), 
+                                         (ezbus_address_t*)ezbus_port_get_address( &bench_ports[1] ), 
+                                         EZBUS_SOCKET_ANY );
+    ack_seq    = ezbus_socket_get_tx_ack_seq( ezbus_mac( &bench_nodes[0] ), bench_tx_socket );
+    wire_start = bench_bus.tx_bytes;
+    deadline   = ezbus_sim_clock_ns() + ( (ezbus_sim_ns_t)seconds * 1000000000ULL );
+
+    while ( ezbus_sim_clock_ns() < deadline && bench_tx_socket != EZBUS_SOCKET_INVALID )
+    {
+        ezbus_sim_bus_run( &bench_bus, bench_nodes, node_count );
+
+        /* each advance of the acknowledged sequence number is one delivered parcel */
+        while ( bench_tx_socket != EZBUS_SOCKET_INVALID && ezbus_socket_get_tx_ack_seq( ezbus_mac( &bench_nodes[0] ), bench_tx_socket ) != ack_seq )
+        {
+            double rtt_ms = (double)( ezbus_sim_clock_ns() - bench_sent_ns[ ack_seq++ ] ) / 1e6;
+            ++result->parcels;
+            result->rtt_sum_ms += rtt_ms;
+            if ( rtt_ms > result->rtt_max_ms )
+            {
+                result->rtt_max_ms = rtt_ms;
+            }
+        }
+    }
+
+    result->payload_bytes = bench_rx_bytes;
+    result->corrupt       = bench_rx_corrupt;
+    result->wire_bytes    = bench_bus.tx_bytes - wire_start;
+    result->pool_tx       = ezbus_pool_get_high_water( ezbus_socket_get_pool( ezbus_mac( &bench_nodes[0] ) ) );
+    result->pool_rx       = ezbus_pool_get_high_water( ezbus_socket_get_pool( ezbus_mac( &bench_nodes[1] ) ) );
+
+    if ( bench_tx_socket != EZBUS_SOCKET_INVALID )
+    {
+        ezbus_socket_close( ezbus_mac( &bench_nodes[0] ), bench_tx_socket );
+    }
+}
+
+static int ezbus_bench_list( char* arg, uint32_t* list )
+{
+    int count = 0;
+    for( char* tok = strtok( arg, "," ); tok != NULL && count < EZBUS_BENCH_MAX_POINTS; tok = strtok( NULL, "," ) )
+    {
+        list[count++] = strtoul( tok, NULL, 10 );
+    }
+    return count;
+}
+
+int main( int argc, char* argv[] )
+{
+    uint32_t    nodes[ EZBUS_BENCH_MAX_POINTS ] = { 2, 4, 8, 16, 32 };
+    uint32_t    speeds[ EZBUS_BENCH_MAX_POINTS ] = { 115200, EZBUS_SPEED_DEF, 2000000 };
+    uint32_t    sizes[ EZBUS_BENCH_MAX_POINTS ] = { 64, 512, EZBUS_PARCEL_DATA_LN };
+    int         node_count = 5;
+    int         speed_count = 3;
+    int         size_count = 3;
+    uint32_t    seconds = 10;
+    int         opt;
+
+    while ( (opt = getopt( argc, argv, "n:s:p:t:z" )) != -1 )
+    {
+        switch( opt )
+        {
+            case 'n': node_count  = ezbus_bench_list( optarg, nodes );  break;
+            case 's': speed_count = ezbus_bench_list( optarg, speeds ); break;
+            case 'p': size_count  = ezbus_bench_list( optarg, sizes );  break;
+            case 't': seconds     = atoi( optarg );                     break;
+            case 'z': bench_zero_copy = true;                           break;
+            default:
+                fprintf( stderr, "usage: %s [-n nodes,..] [-s speed,..] [-p size,..] [-t seconds] [-z]\n", argv[0] );
+                return 1;
+        }
+    }
+
+    for( size_t n=0; n < sizeof(bench_payload); n++ )
+    {
+        bench_payload[n] = (uint8_t)n;
+    }
+
+    printf( "%5s %8s %6s %12s %9s %10s %8s %12s %12s %11s\n", 
+            "nodes", "speed", "size", "goodput B/s", "wire eff%", "line util%", "parcels", "ack rtt ms", "max rtt ms", "pool tx/rx" );
+
+    for( int n=0; n < node_count; n++ )
+    {
+        for( int s=0; s < speed_count; s++ )
+        {
+            for( int p=0; p < size_count; p++ )
+            {
+                ezbus_bench_result_t result;
+
+                if ( nodes[n] < 2 || nodes[n] > EZBUS_SIM_MAX_PORTS || sizes[p] < 1 || sizes[p] > EZBUS_BENCH_MAX_MESSAGE )
+                {
+                    fprintf( stderr, "skipping nodes %u size %u\n", nodes[n], sizes[p] );
+                    continue;
+                }
+
+                ezbus_bench_point( nodes[n], speeds[s], sizes[p], seconds, &result );
+
+                if ( result.booted )
+                {
+                    double goodput = (double)result.payload_bytes / (double)seconds;
+                    printf( "%5u %8u %6u %12.0f %9.1f %10.1f %8u %12.3f %12.3f %7u/%-3u%s\n",
+                            nodes[n], speeds[s], sizes[p],
+                            goodput,
+                            result.wire_bytes ? ( 100.0 * (double)result.payload_bytes / (double)result.wire_bytes ) : 0.0,
+                            100.0 * ( goodput * 10.0 ) / (double)speeds[s],
+                            result.parcels,
+                            result.parcels ? result.rtt_sum_ms / result.parcels : 0.0,
+                            result.rtt_max_ms,
+                            result.pool_tx, result.pool_rx,
+                            result.corrupt ? " CORRUPT" : "" );
+                }
+                else
+                {
+                    printf( "%5u %8u %6u %12s\n", nodes[n], speeds[s], sizes[p], "no boot" );
+                }
+                fflush( stdout );
+            }
+        }
+    }
+    return 0;
+}
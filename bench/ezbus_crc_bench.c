@@ -0,0 +1,163 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+/*****************************************************************************
+* CRC micro-benchmark. Times the CRC16 and CRC32 engines against byte and    *
+* bit at a time reference loops over parcel sized buffers, and checks that   *
+* every engine agrees with its reference.                                    *
+*                                                                            *
+* usage: ezbus_crc_bench [-s size] [-i iterations]                           *
+*****************************************************************************/
+
+#include <ezbus_types.h>
+#include <ezbus_const.h>
+#include <ezbus_crc.h>
+#include <ezbus_crc32.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef uint32_t (*ezbus_crc_bench_fn_t)( void* p, size_t size );
+
+static uint8_t* bench_buffer;
+
+static uint32_t ezbus_crc_bench_crc16_bytewise( void* p, size_t size )
+{
+    ezbus_crc_t crc;
+    uint8_t* d = (uint8_t*)p;
+    ezbus_crc_init( &crc );
+    while ( size-- )
+    {
+        ezbus_crc_update( &crc, *d++ );
+    }
+    return ezbus_crc_word( &crc );
+}
+
+static uint32_t ezbus_crc_bench_crc16( void* p, size_t size )
+{
+    ezbus_crc_t crc;
+    ezbus_crc_init( &crc );
+    return ezbus_crc_word( ezbus_crc( &crc, p, size ) );
+}
+
+static uint32_t ezbus_crc_bench_crc32_bitwise( void* p, size_t size )
+{
+    uint8_t* d = (uint8_t*)p;
+    uint32_t crc = 0xFFFFFFFF;
+    while ( size-- )
+    {
+        crc ^= *d++;
+        for( int bit=0; bit < 8; bit++ )
+        {
+            crc = ( crc & 1 ) ? ( crc >> 1 ) ^ 0xEDB88320 : ( crc >> 1 );
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t ezbus_crc_bench_crc32( void* p, size_t size )
+{
+    return ezbus_crc32( p, size );
+}
+
+static double ezbus_crc_bench_now( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + ( (double)ts.tv_nsec / 1e9 );
+}
+
+static double ezbus_crc_bench_run( ezbus_crc_bench_fn_t fn, size_t size, uint32_t iterations, uint32_t* result )
+{
+    volatile uint32_t sink = 0;
+    double start = ezbus_crc_bench_now();
+    for( uint32_t n=0; n < iterations; n++ )
+    {
+        /* vary the first byte so no call can be hoisted out of the loop */
+        bench_buffer[0] = (uint8_t)n;
+        sink ^= fn( bench_buffer, size );
+    }
+    double elapsed = ezbus_crc_bench_now() - start;
+    bench_buffer[0] = 0;
+    *result = fn( bench_buffer, size );
+    (void)sink;
+    return ( elapsed * 1e9 ) / (double)iterations;
+}
+
+static bool ezbus_crc_bench_pair( const char* name, ezbus_crc_bench_fn_t reference, ezbus_crc_bench_fn_t engine, size_t size, uint32_t iterations )
+{
+    uint32_t reference_crc;
+    uint32_t engine_crc;
+    double   reference_ns = ezbus_crc_bench_run( reference, size, iterations, &reference_crc );
+    double   engine_ns    = ezbus_crc_bench_run( engine,    size, iterations, &engine_crc );
+
+    printf( "%-6s %7zu %14.1f %14.1f %10.1f %10.1f %8.2fx %s\n",
+            name, size,
+            reference_ns, engine_ns,
+            ( (double)size * 1e3 ) / reference_ns,
+            ( (double)size * 1e3 ) / engine_ns,
+            reference_ns / engine_ns,
+            reference_crc == engine_crc ? "ok" : "MISMATCH" );
+
+    return reference_crc == engine_crc;
+}
+
+int main( int argc, char* argv[] )
+{
+    size_t      size = EZBUS_PARCEL_DATA_LN;
+    uint32_t    iterations = 20000;
+    bool        ok = true;
+    int         opt;
+
+    while ( (opt = getopt( argc, argv, "s:i:" )) != -1 )
+    {
+        switch( opt )
+        {
+            case 's': size       = strtoul( optarg, NULL, 10 ); break;
+            case 'i': iterations = strtoul( optarg, NULL, 10 ); break;
+            default:
+                fprintf( stderr, "usage: %s [-s size] [-i iterations]\n", argv[0] );
+                return 1;
+        }
+    }
+
+    if ( size < 1 || iterations < 1 || (bench_buffer = malloc( size )) == NULL )
+    {
+        fprintf( stderr, "bad size or iterations\n" );
+        return 1;
+    }
+
+    srand( 1 );
+    for( size_t n=0; n < size; n++ )
+    {
+        bench_buffer[n] = (uint8_t)rand();
+    }
+
+    printf( "%-6s %7s %14s %14s %10s %10s %9s\n", 
+            "crc", "size", "reference ns", "engine ns", "ref MB/s", "eng MB/s", "speedup" );
+
+    ok &= ezbus_crc_bench_pair( "crc16", ezbus_crc_bench_crc16_bytewise, ezbus_crc_bench_crc16, size, iterations );
+    ok &= ezbus_crc_bench_pair( "crc32", ezbus_crc_bench_crc32_bitwise,  ezbus_crc_bench_crc32, size, iterations );
+
+    free( bench_buffer );
+    return ok ? 0 : 1;
+}
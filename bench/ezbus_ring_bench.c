@@ -0,0 +1,254 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+/*****************************************************************************
+* Ring micro-benchmark. Streams sequence numbered records from a producer    *
+* thread to a consumer thread, through the lock-free ezbus_ring_t and        *
+* through a mutex guarded reference ring of the same shape, and checks that  *
+* every record arrives intact and in order.                                  *
+*                                                                            *
+* usage: ezbus_ring_bench [-s record size] [-c records] [-i iterations]      *
+*****************************************************************************/
+
+#include <ezbus_types.h>
+#include <ezbus_const.h>
+#include <ezbus_ring.h>
+#include <ezbus_platform.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+typedef struct _ezbus_ring_bench_mutex_t
+{
+    pthread_mutex_t     lock;
+    uint8_t*            records;
+    size_t              record_size;
+    uint32_t            count;
+    uint32_t            head;
+    uint32_t            tail;
+} ezbus_ring_bench_mutex_t;
+
+typedef struct _ezbus_ring_bench_t
+{
+    bool                        lock_free;
+    ezbus_ring_t                ring;
+    ezbus_ring_bench_mutex_t    mutex;
+    size_t                      record_size;
+    uint32_t                    iterations;
+    uint32_t                    errors;
+} ezbus_ring_bench_t;
+
+static void* ezbus_ring_bench_mutex_reserve( ezbus_ring_bench_mutex_t* ring )
+{
+    void* record = NULL;
+    pthread_mutex_lock( &ring->lock );
+    if ( ring->head - ring->tail < ring->count )
+    {
+        record = &ring->records[ ( ring->head % ring->count ) * ring->record_size ];
+    }
+    pthread_mutex_unlock( &ring->lock );
+    return record;
+}
+
+static void ezbus_ring_bench_mutex_commit( ezbus_ring_bench_mutex_t* ring )
+{
+    pthread_mutex_lock( &ring->lock );
+    ++ring->head;
+    pthread_mutex_unlock( &ring->lock );
+}
+
+static void* ezbus_ring_bench_mutex_peek( ezbus_ring_bench_mutex_t* ring )
+{
+    void* record = NULL;
+    pthread_mutex_lock( &ring->lock );
+    if ( ring->head != ring->tail )
+    {
+        record = &ring->records[ ( ring->tail % ring->count ) * ring->record_size ];
+    }
+    pthread_mutex_unlock( &ring->lock );
+    return record;
+}
+
+static void ezbus_ring_bench_mutex_release( ezbus_ring_bench_mutex_t* ring )
+{
+    pthread_mutex_lock( &ring->lock );
+    ++ring->tail;
+    pthread_mutex_unlock( &ring->lock );
+}
+
+static void ezbus_ring_bench_fill( uint8_t* record, size_t size, uint32_t seq )
+{
+    memcpy( record, &seq, sizeof(seq) );
+    for( size_t n=sizeof(seq); n < size; n++ )
+    {
+        record[n] = (uint8_t)( seq + n );
+    }
+}
+
+static bool ezbus_ring_bench_check( uint8_t* record, size_t size, uint32_t seq )
+{
+    uint32_t got;
+    memcpy( &got, record, sizeof(got) );
+    if ( got != seq )
+    {
+        return false;
+    }
+    for( size_t n=sizeof(seq); n < size; n++ )
+    {
+        if ( record[n] != (uint8_t)( seq + n ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void* ezbus_ring_bench_producer( void* arg )
+{
+    ezbus_ring_bench_t* bench = (ezbus_ring_bench_t*)arg;
+    for( uint32_t seq=0; seq < bench->iterations; seq++ )
+    {
+        uint8_t* record;
+        while ( (record = bench->lock_free ? ezbus_ring_reserve( &bench->ring ) : ezbus_ring_bench_mutex_reserve( &bench->mutex )) == NULL )
+        {
+            sched_yield();
+        }
+        ezbus_ring_bench_fill( record, bench->record_size, seq );
+        if ( bench->lock_free )
+            ezbus_ring_commit( &bench->ring );
+        else
+            ezbus_ring_bench_mutex_commit( &bench->mutex );
+    }
+    return NULL;
+}
+
+static void* ezbus_ring_bench_consumer( void* arg )
+{
+    ezbus_ring_bench_t* bench = (ezbus_ring_bench_t*)arg;
+    for( uint32_t seq=0; seq < bench->iterations; seq++ )
+    {
+        uint8_t* record;
+        while ( (record = bench->lock_free ? ezbus_ring_peek( &bench->ring ) : ezbus_ring_bench_mutex_peek( &bench->mutex )) == NULL )
+        {
+            sched_yield();
+        }
+        if ( !ezbus_ring_bench_check( record, bench->record_size, seq ) )
+        {
+            ++bench->errors;
+        }
+        if ( bench->lock_free )
+            ezbus_ring_release( &bench->ring );
+        else
+            ezbus_ring_bench_mutex_release( &bench->mutex );
+    }
+    return NULL;
+}
+
+static double ezbus_ring_bench_now( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + ( (double)ts.tv_nsec / 1e9 );
+}
+
+static double ezbus_ring_bench_run( ezbus_ring_bench_t* bench )
+{
+    pthread_t producer;
+    pthread_t consumer;
+    double    start = ezbus_ring_bench_now();
+
+    pthread_create( &consumer, NULL, ezbus_ring_bench_consumer, bench );
+    pthread_create( &producer, NULL, ezbus_ring_bench_producer, bench );
+    pthread_join( producer, NULL );
+    pthread_join( consumer, NULL );
+
+    return ezbus_ring_bench_now() - start;
+}
+
+int main( int argc, char* argv[] )
+{
+    ezbus_ring_bench_t  bench;
+    size_t              record_size = 64;
+    uint32_t            count = 64;
+    uint32_t            iterations = 1000000;
+    double              mutex_s;
+    double              ring_s;
+    uint32_t            mutex_errors;
+    void*               records;
+    int                 opt;
+
+    while ( (opt = getopt( argc, argv, "s:c:i:" )) != -1 )
+    {
+        switch( opt )
+        {
+            case 's': record_size = strtoul( optarg, NULL, 10 ); break;
+            case 'c': count       = strtoul( optarg, NULL, 10 ); break;
+            case 'i': iterations  = strtoul( optarg, NULL, 10 ); break;
+            default:
+                fprintf( stderr, "usage: %s [-s record size] [-c records] [-i iterations]\n", argv[0] );
+                return 1;
+        }
+    }
+
+    if ( record_size < sizeof(uint32_t) || iterations < 1 || (records = malloc( record_size * count )) == NULL )
+    {
+        fprintf( stderr, "bad record size, records or iterations\n" );
+        return 1;
+    }
+
+    ezbus_platform_setup( NULL );
+    memset( &bench, 0, sizeof(bench) );
+    bench.record_size = record_size;
+    bench.iterations  = iterations;
+    if ( ezbus_ring_init( &bench.ring, records, record_size, count ) != EZBUS_ERR_OKAY )
+    {
+        fprintf( stderr, "records must be a power of 2\n" );
+        return 1;
+    }
+    pthread_mutex_init( &bench.mutex.lock, NULL );
+    bench.mutex.records     = records;
+    bench.mutex.record_size = record_size;
+    bench.mutex.count       = count;
+
+    bench.lock_free = false;
+    mutex_s         = ezbus_ring_bench_run( &bench );
+    mutex_errors    = bench.errors;
+    bench.errors    = 0;
+    bench.lock_free = true;
+    ring_s          = ezbus_ring_bench_run( &bench );
+
+    printf( "%-6s %7s %7s %14s %14s %10s %10s %9s\n", 
+            "ring", "size", "records", "mutex ns/rec", "spsc ns/rec", "mutex MB/s", "spsc MB/s", "speedup" );
+    printf( "%-6s %7zu %7u %14.1f %14.1f %10.1f %10.1f %8.2fx %s\n",
+            "spsc", record_size, count,
+            ( mutex_s * 1e9 ) / iterations, ( ring_s * 1e9 ) / iterations,
+            ( (double)record_size * iterations ) / ( mutex_s * 1e6 ),
+            ( (double)record_size * iterations ) / ( ring_s * 1e6 ),
+            mutex_s / ring_s,
+            ( mutex_errors || bench.errors ) ? "MISMATCH" : "ok" );
+
+    pthread_mutex_destroy( &bench.mutex.lock );
+    free( records );
+    return ( mutex_errors || bench.errors ) ? 1 : 0;
+}
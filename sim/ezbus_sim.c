@@ -0,0 +1,156 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+
+/*****************************************************************************
+* Runs a number of ezbus nodes in one process, attached to a simulated       *
+* RS-485 segment, and reports boot convergence and token rotation.           *
+* Runs on the virtual clock unless -w (wall clock) is given, in which case   *
+* the run takes 'seconds' of real time.                                      *
+*                                                                            *
+* usage: ezbus_sim [-n nodes] [-s speed] [-t seconds] [-r seed] [-w]         *
+*****************************************************************************/
+
+#include <ezbus.h>
+#include <ezbus_mac.h>
+#include <ezbus_mac_peers.h>
+#include <ezbus_mac_token.h>
+#include <ezbus_mac_arbiter.h>
+#include <ezbus_socket.h>
+#include <ezbus_platform.h>
+#include <ezbus_sim_bus.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static ezbus_sim_bus_t  sim_bus;
+static ezbus_port_t     sim_ports[ EZBUS_SIM_MAX_PORTS ];
+static ezbus_t          sim_nodes[ EZBUS_SIM_MAX_PORTS ];
+
+static bool ezbus_sim_socket_send ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    return false;
+}
+
+static bool ezbus_sim_socket_recv ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    return true;
+}
+
+static void ezbus_sim_socket_closing ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+}
+
+static bool ezbus_sim_converged( int node_count )
+{
+    for( int n=0; n < node_count; n++ )
+    {
+        ezbus_mac_t* mac = ezbus_mac( &sim_nodes[n] );
+        if ( !ezbus_mac_arbiter_online( mac ) || ezbus_mac_peers_count( mac ) != node_count )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main( int argc, char* argv[] )
+{
+    int             node_count = 4;
+    uint32_t        speed      = EZBUS_SPEED_DEF;
+    uint32_t        seconds    = 10;
+    ezbus_sim_ns_t  start;
+    ezbus_sim_ns_t  converged  = 0;
+    uint32_t        ring_start = 0;
+    int             opt;
+
+    ezbus_sim_clock_set_source( ezbus_sim_clock_virtual );
+    while ( (opt = getopt( argc, argv, "n:s:t:r:w" )) != -1 )
+    {
+        switch( opt )
+        {
+            case 'n': node_count = atoi( optarg );  break;
+            case 's': speed      = atoi( optarg );  break;
+            case 't': seconds    = atoi( optarg );  break;
+            case 'r': ezbus_sim_clock_set_seed( atoi( optarg ) ); break;
+            case 'w': ezbus_sim_clock_set_source( ezbus_sim_clock_wall ); break;
+            default:
+                fprintf( stderr, "usage: %s [-n nodes] [-s speed] [-t seconds] [-r seed] [-w]\n", argv[0] );
+                return 1;
+        }
+    }
+    if ( node_count < 1 || node_count > EZBUS_SIM_MAX_PORTS )
+    {
+        fprintf( stderr, "nodes 1..%d\n", EZBUS_SIM_MAX_PORTS );
+        return 1;
+    }
+
+    ezbus_platform_setup( NULL );
+    ezbus_sim_bus_init( &sim_bus, EZBUS_SIM_TURNAROUND_NS );
+
+    for( int n=0; n < node_count; n++ )
+    {
+        ezbus_address_t address;
+        address.word = 0x1000 + ( n * 0x11 );
+        ezbus_sim_bus_attach( &sim_bus, &sim_ports[n], speed, &address );
+        if ( ezbus_port_open( &sim_ports[n] ) != EZBUS_ERR_OKAY )
+        {
+            fprintf( stderr, "port #%d open failed\n", n );
+            return 1;
+        }
+        ezbus_init( &sim_nodes[n], &sim_ports[n] );
+        ezbus_socket_init( ezbus_mac( &sim_nodes[n] ), ezbus_sim_socket_send, ezbus_sim_socket_recv, ezbus_sim_socket_closing, NULL );
+    }
+
+    start = ezbus_sim_clock_ns();
+    while ( ezbus_sim_clock_ns() - start < (ezbus_sim_ns_t)seconds * 1000000000ULL )
+    {
+        ezbus_sim_bus_run( &sim_bus, sim_nodes, node_count );
+        if ( !converged && ezbus_sim_converged( node_count ) )
+        {
+            converged  = ezbus_sim_clock_ns();
+            ring_start = ezbus_mac_token_ring_count( ezbus_mac( &sim_nodes[0] ) );
+        }
+    }
+
+    printf( "nodes %d speed %u clock %s\n", node_count, speed, 
+            ezbus_sim_clock_get_source() == ezbus_sim_clock_virtual ? "virtual" : "wall" );
+    if ( converged )
+    {
+        uint32_t rings = ezbus_mac_token_ring_count( ezbus_mac( &sim_nodes[0] ) ) - ring_start;
+        double   run_s = (double)( ezbus_sim_clock_ns() - converged ) / 1e9;
+        printf( "boot convergence %.3f ms\n", (double)( converged - start ) / 1e6 );
+        printf( "token rotations %u (%.1f /s, %.3f ms/rotation)\n", rings, rings / run_s, rings ? ( run_s * 1e3 ) / rings : 0.0 );
+    }
+    else
+    {
+        printf( "boot did not converge\n" );
+    }
+    for( int n=0; n < node_count; n++ )
+    {
+        ezbus_mac_t* mac = ezbus_mac( &sim_nodes[n] );
+        printf( "node %d %s %s peers %d rings %u\n", n, ezbus_address_string( ezbus_port_get_address( &sim_ports[n] ) ), 
+                ezbus_mac_arbiter_get_state_str( mac ), ezbus_mac_peers_count( mac ), ezbus_mac_token_ring_count( mac ) );
+    }
+    printf( "wire bytes %llu collisions %u busy %.1f%%\n", (unsigned long long)sim_bus.tx_bytes, sim_bus.collisions, 
+            100.0 * (double)sim_bus.busy_time / (double)( ezbus_sim_clock_ns() - start ) );
+
+    return converged ? 0 : 2;
+}
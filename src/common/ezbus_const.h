@@ -104,12 +104,79 @@ typedef unsigned char                   ezbus_socket_t;
 
 
 
+#ifndef EZBUS_CRC_SLICE8
+    #define EZBUS_CRC_SLICE8        1                   /* 4K of const CRC16 tables, and 8K of CRC32 tables when linked, 0 for 512 byte and 1K tables */
+#endif
+
 #define EZBUS_MARK                  0x55                /* Packet lead-in marks */
 #if !defined(EZBUS_PARCEL_DATA_LN)
     #define EZBUS_PARCEL_DATA_LN    2048                /* Maximum data length */
 #endif
-#define EZBUS_TOKEN_HOLD_CYCLES     2                   /* Polling cycles to hold token for */
+#ifndef EZBUS_TOKEN_HOLD_BYTES
+    #define EZBUS_TOKEN_HOLD_BYTES  (EZBUS_SOCKET_WINDOW*EZBUS_PARCEL_DATA_LN) /* Bytes sent per token hold, per unit of weight */
+#endif
+#ifndef EZBUS_TOKEN_WEIGHT
+    #define EZBUS_TOKEN_WEIGHT      1                   /* Default share of EZBUS_TOKEN_HOLD_BYTES per hold */
+#endif
+#ifndef EZBUS_TOKEN_DEMAND_HOPS
+    #define EZBUS_TOKEN_DEMAND_HOPS 8                   /* Hops straight to a demanding peer between full circles, 0 for none */
+#endif
+#ifndef EZBUS_TOKEN_RING_TIME
+    #define EZBUS_TOKEN_RING_TIME   500                 /* Lost token timeout ms until a rotation is measured, and its ceiling */
+#endif
+#define EZBUS_WIRE_BYTE_BITS        12                  /* Bit times per byte on the wire, 8N1 and inter-byte slack */
 #define EZBUS_RETRANSMIT_TRIES      8                   /* Number of re-transmit attempts */
+#ifndef EZBUS_RETRANSMIT_TIME_MAX
+    #define EZBUS_RETRANSMIT_TIME_MAX   8000            /* Ceiling of the backed off retransmit timeout ms */
+#endif
+#ifndef EZBUS_PORT_RX_LN
+    #define EZBUS_PORT_RX_LN        64                  /* Bytes taken from the port per callback_recv */
+#endif
+#ifndef EZBUS_MAX_TIMERS
+    #define EZBUS_MAX_TIMERS        16                  /* Timers which may be set up on one mac */
+#endif
+#if EZBUS_MAX_TIMERS > 32
+    #error "EZBUS_MAX_TIMERS must be <= 32 (one bit per timer)"
+#endif
+#ifndef EZBUS_TIMER_WHEEL_SLOTS
+    #define EZBUS_TIMER_WHEEL_SLOTS 32                  /* Timer wheel slots of 1ms, a power of 2 */
+#endif
+#if EZBUS_TIMER_WHEEL_SLOTS & (EZBUS_TIMER_WHEEL_SLOTS-1)
+    #error "EZBUS_TIMER_WHEEL_SLOTS must be a power of 2"
+#endif
+#ifndef EZBUS_TRANSMIT_QUEUE
+    #define EZBUS_TRANSMIT_QUEUE    4                   /* Frames the mac transmitter can hold */
+#endif
+#ifndef EZBUS_SOCKET_WINDOW
+    #define EZBUS_SOCKET_WINDOW     4                   /* Un-acknowledged parcels in flight per socket */
+#endif
+#if EZBUS_SOCKET_WINDOW < 1 || EZBUS_SOCKET_WINDOW > 128
+    #error "EZBUS_SOCKET_WINDOW must be 1..128 (half the 8-bit sequence space)"
+#endif
+#ifndef EZBUS_SOCKET_RX_PARCELS
+    #define EZBUS_SOCKET_RX_PARCELS 4                   /* Received parcels a socket can queue, a power of 2 */
+#endif
+#if EZBUS_SOCKET_RX_PARCELS < 1 || EZBUS_SOCKET_RX_PARCELS > 128 || ( EZBUS_SOCKET_RX_PARCELS & (EZBUS_SOCKET_RX_PARCELS-1) )
+    #error "EZBUS_SOCKET_RX_PARCELS must be a power of 2, 1..128"
+#endif
+#ifndef EZBUS_POOL_BLOCKS
+    #define EZBUS_POOL_BLOCKS       16                  /* Parcel buffers shared by the sockets of a mac */
+#endif
+#if EZBUS_POOL_BLOCKS < 2
+    #error "EZBUS_POOL_BLOCKS must allow at least one parcel each way"
+#endif
+#ifndef EZBUS_CACHE_LINE
+    #define EZBUS_CACHE_LINE        64                  /* Alignment keeping producer and consumer ring indices apart */
+#endif
+#ifndef EZBUS_THREAD_RING_LN
+    #define EZBUS_THREAD_RING_LN    8                   /* Records in each direction between application and bus thread */
+#endif
+#if EZBUS_THREAD_RING_LN & (EZBUS_THREAD_RING_LN-1)
+    #error "EZBUS_THREAD_RING_LN must be a power of 2"
+#endif
+#ifndef EZBUS_THREAD_RECORD_LN
+    #define EZBUS_THREAD_RECORD_LN  EZBUS_PARCEL_DATA_LN /* Data bytes carried by one ring record */
+#endif
 #ifndef EZBUS_SPEED_DEF
     #define EZBUS_SPEED_DEF         1000000
 #endif
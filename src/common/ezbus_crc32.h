@@ -28,8 +28,17 @@
 extern "C" {
 #endif
 
+/**
+ * @brief CRC-32 (IEEE 802.3) of a buffer.
+ */
 extern uint32_t ezbus_crc32( void* p, size_t size );
 
+/**
+ * @brief Streaming form, start with crc=0 and pass back each result to continue.
+ *          ezbus_crc32_update( ezbus_crc32_update( 0, a, n ), b, m ) equals the CRC of a followed by b.
+ */
+extern uint32_t ezbus_crc32_update( uint32_t crc, void* p, size_t size );
+
 #ifdef __cplusplus
 }
 #endif
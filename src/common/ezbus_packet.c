@@ -26,10 +26,16 @@
 #include <ezbus_hex.h>
 #include <ezbus_platform.h>
 
+/**
+ * @brief Clear the header, the data crc, and the fixed size attachments, all that a control 
+ *        frame holds. A parcel payload is left as it is, only the parcel size is cleared, 
+ *        since only that many bytes are sent.
+ */
 void ezbus_packet_init(ezbus_packet_t* packet)
 {
-    ezbus_platform.callback_memset(packet,0,sizeof(ezbus_packet_t));
+    ezbus_platform.callback_memset(packet,0,sizeof(ezbus_packet_control_t));
     ezbus_packet_set_version(packet,PACKET_BITS_VERSION);
+    ezbus_packet_set_chain   ( packet, PACKET_BITS_CHAIN_SINGLE );
     ezbus_packet_set_ack_req ( packet, PACKET_BITS_ACK_REQ );
 }
 
@@ -48,22 +54,34 @@ extern void ezbus_packet_set_bits( ezbus_packet_t* packet, uint16_t bits )
 
 extern void ezbus_packet_set_version( ezbus_packet_t* packet, uint16_t version )
 {
-    packet->header.data.field.bits &= PACKET_BITS_VERSION_MASK;
+    packet->header.data.field.bits &= ~PACKET_BITS_VERSION_MASK;
     packet->header.data.field.bits |= (version & PACKET_BITS_VERSION_MASK);
 }
 
 extern void ezbus_packet_set_chain( ezbus_packet_t* packet, uint16_t chain )
 {
-    packet->header.data.field.bits &= PACKET_BITS_CHAIN_MASK;
+    packet->header.data.field.bits &= ~PACKET_BITS_CHAIN_MASK;
     packet->header.data.field.bits |= (chain & PACKET_BITS_CHAIN_MASK);
 }
 
 extern void ezbus_packet_set_ack_req( ezbus_packet_t* packet, uint16_t ack_req )
 {
-    packet->header.data.field.bits &= PACKET_BITS_ACK_REQ_MASK;
+    packet->header.data.field.bits &= ~PACKET_BITS_ACK_REQ_MASK;
     packet->header.data.field.bits |= (ack_req & PACKET_BITS_ACK_REQ_MASK);
 }
 
+extern void ezbus_packet_set_demand( ezbus_packet_t* packet, uint16_t demand )
+{
+    packet->header.data.field.bits &= ~PACKET_BITS_DEMAND_MASK;
+    packet->header.data.field.bits |= (demand & PACKET_BITS_DEMAND_MASK);
+}
+
+extern void ezbus_packet_set_urgent( ezbus_packet_t* packet, uint16_t urgent )
+{
+    packet->header.data.field.bits &= ~PACKET_BITS_URGENT_MASK;
+    packet->header.data.field.bits |= (urgent & PACKET_BITS_URGENT_MASK);
+}
+
 extern void ezbus_packet_set_seq( ezbus_packet_t* packet, uint8_t seq )
 {
     packet->header.data.field.seq = seq;
@@ -105,6 +123,16 @@ extern void ezbus_packet_set_token_age( ezbus_packet_t* packet, uint16_t age )
     packet->data.attachment.token.age = age;
 }
 
+extern void ezbus_packet_set_token_hops( ezbus_packet_t* packet, uint8_t hops )
+{
+    packet->data.attachment.token.hops = hops;
+}
+
+extern void ezbus_packet_set_token_sweep( ezbus_packet_t* packet, uint8_t sweep )
+{
+    packet->data.attachment.token.sweep = sweep;
+}
+
 extern ezbus_crc_t* ezbus_packet_get_token_crc( ezbus_packet_t* packet )
 {
     return &packet->data.attachment.token.crc;
@@ -115,6 +143,16 @@ extern uint16_t ezbus_packet_get_token_age( ezbus_packet_t* packet )
     return packet->data.attachment.token.age;
 }
 
+extern uint8_t ezbus_packet_get_token_hops( ezbus_packet_t* packet )
+{
+    return packet->data.attachment.token.hops;
+}
+
+extern uint8_t ezbus_packet_get_token_sweep( ezbus_packet_t* packet )
+{
+    return packet->data.attachment.token.sweep;
+}
+
 
 
 extern uint16_t ezbus_packet_bits( ezbus_packet_t* packet )
@@ -137,6 +175,16 @@ extern uint16_t ezbus_packet_ack_req( ezbus_packet_t* packet )
     return packet->header.data.field.bits & PACKET_BITS_ACK_REQ_MASK;
 }
 
+extern uint16_t ezbus_packet_demand( ezbus_packet_t* packet )
+{
+    return packet->header.data.field.bits & PACKET_BITS_DEMAND_MASK;
+}
+
+extern uint16_t ezbus_packet_urgent( ezbus_packet_t* packet )
+{
+    return packet->header.data.field.bits & PACKET_BITS_URGENT_MASK;
+}
+
 extern uint8_t ezbus_packet_seq( ezbus_packet_t* packet )
 {
     return packet->header.data.field.seq;
@@ -170,9 +218,12 @@ extern ezbus_socket_t ezbus_packet_src_socket( ezbus_packet_t* packet )
 }
 
 
+/**
+ * @brief Copy only as much of the packet as goes out on the wire.
+ */
 extern void ezbus_packet_copy( ezbus_packet_t* dst, const ezbus_packet_t* src )
 {
-    ezbus_platform.callback_memcpy( dst, src, sizeof( ezbus_packet_t ) );
+    ezbus_platform.callback_memcpy( dst, src, ezbus_packet_tx_size( (ezbus_packet_t*)src ) );
 }
 
 extern void ezbus_packet_calc_crc( ezbus_packet_t* packet )
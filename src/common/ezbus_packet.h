@@ -38,7 +38,7 @@ extern "C" {
 #define PACKET_BITS_VERSION_1 		(0x02<<PACKET_BITS_VERSION_POS)
 #define PACKET_BITS_VERSION_2 		(0x04<<PACKET_BITS_VERSION_POS)
 #define PACKET_BITS_VERSION_3 		(0x08<<PACKET_BITS_VERSION_POS)
-#define PACKET_BITS_VERSION 		(PACKET_BITS_VERSION_0)
+#define PACKET_BITS_VERSION 		(PACKET_BITS_VERSION_1)	/* 1: token carries hops and sweep, frames of any other version are dropped */
 
 #define PACKET_BITS_CHAIN_POS		4
 #define PACKET_BITS_CHAIN_MASK 		(0x03<<PACKET_BITS_CHAIN_POS)
@@ -53,6 +53,14 @@ extern "C" {
 #define PACKET_BITS_ACK_REQ_MASK    (0x01<<PACKET_BITS_ACK_REQ_POS)
 #define PACKET_BITS_ACK_REQ 		(PACKET_BITS_ACK_REQ_MASK)
 
+#define PACKET_BITS_DEMAND_POS		7
+#define PACKET_BITS_DEMAND_MASK		(0x01<<PACKET_BITS_DEMAND_POS)
+#define PACKET_BITS_DEMAND 			(PACKET_BITS_DEMAND_MASK)	/* the sender wants the token back */
+
+#define PACKET_BITS_URGENT_POS		8
+#define PACKET_BITS_URGENT_MASK		(0x01<<PACKET_BITS_URGENT_POS)
+#define PACKET_BITS_URGENT 			(PACKET_BITS_URGENT_MASK)	/* real-time class parcel, or a sender with such parcels waiting */
+
 typedef enum
 {
 	packet_type_reset=0x00,		/* 00 */
@@ -101,6 +109,8 @@ typedef struct
 {
 	ezbus_crc_t 		crc;
 	uint16_t			age;
+	uint8_t				hops;		/* demand hops since the last full circle */
+	uint8_t				sweep;		/* hops left in the full circle under way */
 } ezbus_token_t;
 
 typedef struct
@@ -121,8 +131,31 @@ typedef struct
 	ezbus_data_t 		data;
 } ezbus_packet_t;
 
+/**
+ * @brief Storage for a control frame, a token, pause, speed, ack, boot frame, or a parcel without
+ *        payload. Laid out as the head of an ezbus_packet_t, without room for the parcel payload, 
+ *        and handled as an ezbus_packet_t through @ref ezbus_packet_control().
+ */
+typedef struct
+{
+	ezbus_header_t		header;
+	struct
+	{
+		ezbus_crc_t 	crc;
+		union
+		{
+			uint16_t		parcel_size;
+			ezbus_pause_t   pause;
+			ezbus_speed_t	speed;
+			ezbus_token_t	token;
+		} attachment;
+	} data;
+} ezbus_packet_control_t;
+
 #pragma pack(pop)
 
+#define ezbus_packet_control(control)	((ezbus_packet_t*)(control))
+
 extern void					ezbus_packet_init 				( ezbus_packet_t* packet );
 extern void					ezbus_packet_deinit 			( ezbus_packet_t* packet );
 
@@ -130,6 +163,8 @@ extern void 				ezbus_packet_set_bits 			( ezbus_packet_t* packet, uint16_t bits
 extern void 				ezbus_packet_set_version		( ezbus_packet_t* packet, uint16_t version );
 extern void 				ezbus_packet_set_chain 			( ezbus_packet_t* packet, uint16_t chain );
 extern void 				ezbus_packet_set_ack_req		( ezbus_packet_t* packet, uint16_t ack_req );
+extern void 				ezbus_packet_set_demand			( ezbus_packet_t* packet, uint16_t demand );
+extern void 				ezbus_packet_set_urgent			( ezbus_packet_t* packet, uint16_t urgent );
 extern void 				ezbus_packet_set_seq 			( ezbus_packet_t* packet, uint8_t seq );
 extern void 				ezbus_packet_set_type 			( ezbus_packet_t* packet, ezbus_packet_type_t type );
 extern void 				ezbus_packet_set_src			( ezbus_packet_t* packet, const ezbus_address_t* address );
@@ -138,11 +173,15 @@ extern void 				ezbus_packet_set_src_socket		( ezbus_packet_t* packet, ezbus_soc
 extern void 				ezbus_packet_set_dst_socket		( ezbus_packet_t* packet, ezbus_socket_t socket );
 extern void 				ezbus_packet_set_token_crc		( ezbus_packet_t* packet, const ezbus_crc_t* crc );
 extern void					ezbus_packet_set_token_age      ( ezbus_packet_t* packet, uint16_t age );
+extern void					ezbus_packet_set_token_hops     ( ezbus_packet_t* packet, uint8_t hops );
+extern void					ezbus_packet_set_token_sweep    ( ezbus_packet_t* packet, uint8_t sweep );
 
 extern uint16_t				ezbus_packet_bits           	( ezbus_packet_t* packet );	
 extern uint16_t				ezbus_packet_version           	( ezbus_packet_t* packet );	
 extern uint16_t				ezbus_packet_chain           	( ezbus_packet_t* packet );	
 extern uint16_t				ezbus_packet_ack_req          	( ezbus_packet_t* packet );	
+extern uint16_t				ezbus_packet_demand          	( ezbus_packet_t* packet );	
+extern uint16_t				ezbus_packet_urgent          	( ezbus_packet_t* packet );	
 extern uint8_t 				ezbus_packet_seq           		( ezbus_packet_t* packet );	
 extern ezbus_packet_type_t 	ezbus_packet_type           	( ezbus_packet_t* packet );	
 extern ezbus_address_t*		ezbus_packet_dst 				( ezbus_packet_t* packet );
@@ -151,6 +190,8 @@ extern ezbus_socket_t		ezbus_packet_dst_socket 	    ( ezbus_packet_t* packet );
 extern ezbus_socket_t 		ezbus_packet_src_socket 		( ezbus_packet_t* packet );
 extern ezbus_crc_t* 		ezbus_packet_get_token_crc		( ezbus_packet_t* packet );
 extern uint16_t 			ezbus_packet_get_token_age      ( ezbus_packet_t* packet );
+extern uint8_t 				ezbus_packet_get_token_hops     ( ezbus_packet_t* packet );
+extern uint8_t 				ezbus_packet_get_token_sweep    ( ezbus_packet_t* packet );
 
 extern uint16_t				ezbus_packet_tx_size 		    ( ezbus_packet_t* packet );
 extern void 				ezbus_packet_flip 				( ezbus_packet_t* packet );
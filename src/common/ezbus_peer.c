@@ -29,6 +29,9 @@ extern void ezbus_peer_init( ezbus_peer_t* peer, const ezbus_address_t* address,
 {
     ezbus_address_copy( &peer->address, address );
     peer->seq = seq;
+    peer->demand = false;
+    peer->urgent = false;
+    ezbus_rtt_init( &peer->rtt );
 }
 
 extern ezbus_address_t* ezbus_peer_get_address( const ezbus_peer_t* peer )
@@ -60,6 +63,40 @@ extern uint8_t ezbus_peer_set_seq( const ezbus_peer_t* peer, uint8_t seq )
     return 0;
 }
 
+extern bool ezbus_peer_get_demand( const ezbus_peer_t* peer )
+{
+    return peer != NULL && peer->demand;
+}
+
+extern void ezbus_peer_set_demand( ezbus_peer_t* peer, bool demand )
+{
+    if ( peer != NULL )
+    {
+        peer->demand = demand;
+    }
+}
+
+extern bool ezbus_peer_get_urgent( const ezbus_peer_t* peer )
+{
+    return peer != NULL && peer->urgent;
+}
+
+extern void ezbus_peer_set_urgent( ezbus_peer_t* peer, bool urgent )
+{
+    if ( peer != NULL )
+    {
+        peer->urgent = urgent;
+    }
+}
+
+extern ezbus_rtt_t* ezbus_peer_get_rtt( ezbus_peer_t* peer )
+{
+    if ( peer != NULL )
+    {
+        return &peer->rtt;
+    }
+    return NULL;
+}
 
 /**
  * @brief Compare address a vs b
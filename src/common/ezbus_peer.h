@@ -23,6 +23,7 @@
 #define EZBUS_PEER_H_
 
 #include <ezbus_types.h>
+#include <ezbus_rtt.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,12 +33,20 @@ typedef struct
 {
     ezbus_address_t     address;
     uint8_t             seq;
+    bool                demand;         /* advertised wanting the token, see PACKET_BITS_DEMAND */
+    bool                urgent;         /* advertised real-time traffic waiting, see PACKET_BITS_URGENT */
+    ezbus_rtt_t         rtt;            /* from a parcel sent to this peer to its ack */
 } ezbus_peer_t;
 
 extern void             ezbus_peer_init         ( ezbus_peer_t* peer, const ezbus_address_t* address, uint8_t seq );
 extern ezbus_address_t* ezbus_peer_get_address  ( const ezbus_peer_t* peer );
 extern uint8_t          ezbus_peer_get_seq      ( const ezbus_peer_t* peer );
 extern uint8_t          ezbus_peer_set_seq      ( const ezbus_peer_t* peer, uint8_t seq );
+extern bool             ezbus_peer_get_demand   ( const ezbus_peer_t* peer );
+extern void             ezbus_peer_set_demand   ( ezbus_peer_t* peer, bool demand );
+extern bool             ezbus_peer_get_urgent   ( const ezbus_peer_t* peer );
+extern void             ezbus_peer_set_urgent   ( ezbus_peer_t* peer, bool urgent );
+extern ezbus_rtt_t*     ezbus_peer_get_rtt      ( ezbus_peer_t* peer );
 
 extern int              ezbus_peer_compare      ( const ezbus_peer_t* a, const ezbus_peer_t* b );
 extern uint8_t*         ezbus_peer_copy         ( ezbus_peer_t* dst, const ezbus_peer_t* src );
@@ -0,0 +1,104 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#include <ezbus_pool.h>
+#include <ezbus_platform.h>
+
+static uint16_t ezbus_pool_get_link ( ezbus_pool_t* pool, uint16_t index );
+static void     ezbus_pool_set_link ( ezbus_pool_t* pool, uint16_t index, uint16_t next );
+
+extern EZBUS_ERR ezbus_pool_init( ezbus_pool_t* pool, void* blocks, size_t block_size, uint16_t count )
+{
+    if ( count == 0 || block_size < sizeof(uint16_t) )
+    {
+        return EZBUS_ERR_PARAM;
+    }
+    ezbus_platform.callback_memset( pool, 0, sizeof(ezbus_pool_t) );
+    pool->blocks     = (uint8_t*)blocks;
+    pool->block_size = block_size;
+    pool->count      = count;
+    for( uint16_t index=0; index < count; index++ )
+    {
+        ezbus_pool_set_link( pool, index, index+1 );
+    }
+    pool->free = 0;
+    return EZBUS_ERR_OKAY;
+}
+
+extern void* ezbus_pool_alloc( ezbus_pool_t* pool )
+{
+    if ( pool->free < pool->count )
+    {
+        uint16_t index = pool->free;
+        pool->free = ezbus_pool_get_link( pool, index );
+        if ( ++pool->used > pool->high_water )
+        {
+            pool->high_water = pool->used;
+        }
+        return &pool->blocks[ index * pool->block_size ];
+    }
+    ++pool->exhausted;
+    return NULL;
+}
+
+extern void ezbus_pool_free( ezbus_pool_t* pool, void* block )
+{
+    if ( block != NULL )
+    {
+        uint16_t index = ( (uint8_t*)block - pool->blocks ) / pool->block_size;
+        ezbus_pool_set_link( pool, index, pool->free );
+        pool->free = index;
+        --pool->used;
+    }
+}
+
+extern uint16_t ezbus_pool_get_count( ezbus_pool_t* pool )
+{
+    return pool->count;
+}
+
+extern uint16_t ezbus_pool_get_used( ezbus_pool_t* pool )
+{
+    return pool->used;
+}
+
+extern uint16_t ezbus_pool_get_high_water( ezbus_pool_t* pool )
+{
+    return pool->high_water;
+}
+
+extern uint32_t ezbus_pool_get_exhausted( ezbus_pool_t* pool )
+{
+    return pool->exhausted;
+}
+
+/* blocks need not be aligned, the link is copied in and out bytewise */
+static uint16_t ezbus_pool_get_link( ezbus_pool_t* pool, uint16_t index )
+{
+    uint16_t next;
+    ezbus_platform.callback_memcpy( &next, &pool->blocks[ index * pool->block_size ], sizeof(next) );
+    return next;
+}
+
+static void ezbus_pool_set_link( ezbus_pool_t* pool, uint16_t index, uint16_t next )
+{
+    ezbus_platform.callback_memcpy( &pool->blocks[ index * pool->block_size ], &next, sizeof(next) );
+}
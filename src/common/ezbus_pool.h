@@ -0,0 +1,74 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#ifndef EZBUS_POOL_H_
+#define EZBUS_POOL_H_
+
+#include <ezbus_types.h>
+#include <ezbus_const.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A pool of fixed size blocks over caller storage, with no heap. Free blocks are chained 
+ *          through their own first bytes, so allocating and freeing are each O(1).
+ */
+typedef struct _ezbus_pool_t
+{
+    uint8_t*            blocks;
+    size_t              block_size;         /* at least sizeof(uint16_t) */
+    uint16_t            count;
+    uint16_t            free;               /* first free block, count when there is none */
+    uint16_t            used;
+    uint16_t            high_water;         /* most blocks ever in use at once */
+    uint32_t            exhausted;          /* allocations refused for want of a block */
+} ezbus_pool_t;
+
+/**
+ * @brief Initialize a pool over caller storage of count * block_size bytes.
+ * @return EZBUS_ERR_PARAM when the blocks are too small to chain, or count is 0.
+ */
+extern EZBUS_ERR    ezbus_pool_init             ( ezbus_pool_t* pool, void* blocks, size_t block_size, uint16_t count );
+
+/**
+ * @brief A free block, or NULL when all are in use.
+ */
+extern void*        ezbus_pool_alloc            ( ezbus_pool_t* pool );
+
+/**
+ * @brief Return a block obtained from @ref ezbus_pool_alloc(), NULL is ignored.
+ */
+extern void         ezbus_pool_free             ( ezbus_pool_t* pool, void* block );
+
+extern uint16_t     ezbus_pool_get_count        ( ezbus_pool_t* pool );
+extern uint16_t     ezbus_pool_get_used         ( ezbus_pool_t* pool );
+extern uint16_t     ezbus_pool_get_high_water   ( ezbus_pool_t* pool );
+extern uint32_t     ezbus_pool_get_exhausted    ( ezbus_pool_t* pool );
+
+#define ezbus_pool_available(pool)  (ezbus_pool_get_count((pool))-ezbus_pool_get_used((pool)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EZBUS_POOL_H_ */
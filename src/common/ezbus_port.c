@@ -25,8 +25,10 @@
 #include <ezbus_log.h>
 #include <ezbus_platform.h>
 
-static int ezbus_private_recv(ezbus_port_t* port, void* buf, uint32_t index, size_t size);
-static int ezbus_seek_leadin(ezbus_port_t* port);
+static void      ezbus_port_rx_field      ( ezbus_port_t* port, ezbus_port_rx_state_t state, void* dst, uint16_t size );
+static int       ezbus_port_rx_fill       ( ezbus_port_t* port );
+static EZBUS_ERR ezbus_port_rx_field_done ( ezbus_port_t* port, ezbus_packet_t* packet );
+static EZBUS_ERR ezbus_port_rx_parse      ( ezbus_port_t* port, ezbus_packet_t* packet );
 
 extern void ezbus_port_init_struct( ezbus_port_t* port )
 {
@@ -42,6 +44,8 @@ extern EZBUS_ERR ezbus_port_open( ezbus_port_t* port )
         port->rx_err_timeout_count = 0;
         port->rx_err_overrun_count = 0;
         port->tx_err_overrun_count = 0;
+        port->rx_state = port_rx_state_seek;
+        port->rx_head = port->rx_tail = 0;
         return EZBUS_ERR_OKAY;
     }
     return EZBUS_ERR_IO;
@@ -70,139 +74,183 @@ extern EZBUS_ERR ezbus_port_send( ezbus_port_t* port, ezbus_packet_t* packet )
 }
 
 
-static int ezbus_private_recv( ezbus_port_t* port, void* buf, uint32_t index, size_t size )
+static void ezbus_port_rx_field( ezbus_port_t* port, ezbus_port_rx_state_t state, void* dst, uint16_t size )
 {
-    register int ch;
-    register uint8_t* p = (uint8_t*)buf;
-    ezbus_ms_tick_t start = ezbus_platform.callback_get_ms_ticks();
-    /* receive the entire header or timeout... */
-    while ( index < size && (ezbus_platform.callback_get_ms_ticks() - start) <= port->packet_timeout )
+    port->rx_state = state;
+    port->rx_dst   = (uint8_t*)dst;
+    port->rx_index = 0;
+    port->rx_size  = size;
+}
+
+/**
+ * @brief Top up the parse buffer from the port, without waiting.
+ * @return The number of bytes added.
+ */
+static int ezbus_port_rx_fill( ezbus_port_t* port )
+{
+    int count = 0;
+
+    port->rx_head = port->rx_tail = 0;
+    if ( port->callback_recv )
+    {
+        count = port->callback_recv( port, port->rx_buffer, EZBUS_PORT_RX_LN );
+    }
+    else
     {
-        if ( (ch = ezbus_port_getch(port)) >= 0 )
+        int ch;
+        while ( count < EZBUS_PORT_RX_LN && (ch = ezbus_port_getch( port )) >= 0 )
         {
-            p[index++] = ch;
-            start = ezbus_platform.callback_get_ms_ticks();
+            port->rx_buffer[ count++ ] = ch;
         }
     }
-    return index;
+    if ( count > 0 )
+    {
+        port->rx_head = count;
+        port->rx_tick = ezbus_platform.callback_get_ms_ticks();
+    }
+    return count < 0 ? 0 : count;
 }
 
-
-static int ezbus_seek_leadin( ezbus_port_t* port )
+/**
+ * @brief Advance the parser past a completed field.
+ * @return EZBUS_ERR_NOTREADY to continue with the next field, else the outcome of the frame.
+ */
+static EZBUS_ERR ezbus_port_rx_field_done( ezbus_port_t* port, ezbus_packet_t* packet )
 {
-    int ch;
+    switch( port->rx_state )
+    {
+        case port_rx_state_header:
+            ezbus_port_rx_field( port, port_rx_state_header_crc, &packet->header.crc, sizeof( ezbus_crc_t ) );
+            break;
 
-    do { ch = ezbus_port_getch( port ); } while ( ch >= 0 && ch != EZBUS_MARK );
-    
-    return ch;
+        case port_rx_state_header_crc:
+            ezbus_packet_header_flip( packet );
+            if ( !ezbus_crc_equal( &packet->header.crc, &port->rx_crc ) )
+            {
+                return EZBUS_ERR_HEADER_CRC;
+            }
+            if ( ezbus_packet_version( packet ) != PACKET_BITS_VERSION )
+            {
+                /* another wire format, its data can not be parsed */
+                return EZBUS_ERR_MISMATCH;
+            }
+            if ( !ezbus_packet_has_data( packet ) )
+            {
+                return EZBUS_ERR_OKAY;
+            }
+            ezbus_port_rx_field( port, port_rx_state_data_crc, &packet->data.crc, sizeof( ezbus_crc_t ) );
+            break;
+
+        case port_rx_state_data_crc:
+            ezbus_crc_init( &port->rx_crc );
+            switch ( ezbus_packet_type( packet ) )
+            {
+                case packet_type_parcel:
+                    /* variable parcel data transport size... */
+                    ezbus_port_rx_field( port, port_rx_state_parcel_size, &ezbus_packet_get_parcel( packet )->size, sizeof(uint16_t) );
+                    break;
+                case packet_type_take_token:
+                case packet_type_give_token:
+                case packet_type_speed:
+                case packet_type_pause:
+                    ezbus_port_rx_field( port, port_rx_state_data, ezbus_packet_data( packet ), ezbus_packet_data_tx_size( packet ) );
+                    break;
+                default:
+                    return EZBUS_ERR_MISMATCH;
+            }
+            break;
+
+        case port_rx_state_parcel_size:
+            {
+                ezbus_parcel_t* parcel = ezbus_packet_get_parcel( packet );
+                if ( parcel->size > EZBUS_PARCEL_DATA_LN  )
+                {
+                    return EZBUS_ERR_RANGE;
+                }
+                ezbus_port_rx_field( port, port_rx_state_data, parcel->bytes, parcel->size );
+            }
+            break;
+
+        case port_rx_state_data:
+            ezbus_packet_data_flip( packet );
+            return ezbus_crc_equal( &packet->data.crc, &port->rx_crc ) ? EZBUS_ERR_OKAY : EZBUS_ERR_DATA_CRC;
+
+        default:
+            break;
+    }
+    return EZBUS_ERR_NOTREADY;
 }
 
-extern EZBUS_ERR ezbus_port_recv( ezbus_port_t* port, ezbus_packet_t* packet )
+/**
+ * @brief Feed buffered bytes through the parser. Fields are copied a run at a time, and the 
+ *          frame CRC advances over each run as it is stored, so it is complete with the last byte.
+ */
+static EZBUS_ERR ezbus_port_rx_parse( ezbus_port_t* port, ezbus_packet_t* packet )
 {
-    EZBUS_ERR err   = EZBUS_ERR_NOTREADY;
-    int       index = 0;
-    uint8_t*  p     = (uint8_t*)&packet->header;
-    int ch;
+    EZBUS_ERR err = EZBUS_ERR_NOTREADY;
 
-    ch = ezbus_seek_leadin( port );
-    if ( ch == EZBUS_MARK )
+    while ( err == EZBUS_ERR_NOTREADY && port->rx_tail < port->rx_head )
     {
-        p[ index++ ] = ch;
-        index = ezbus_private_recv( port, p, index, sizeof( ezbus_header_t ) );
-        if ( index == sizeof( ezbus_header_t ) )
+        if ( port->rx_state == port_rx_state_seek )
         {
-            ezbus_packet_header_flip( packet );
-            if ( ezbus_packet_header_valid_crc( packet ) )
+            if ( port->rx_buffer[ port->rx_tail ] == EZBUS_MARK )
             {
-                if ( ezbus_packet_has_data( packet ) )
-                {
-                    index = ezbus_private_recv( port, &packet->data.crc, 0, sizeof( ezbus_crc_t ) );
-                    if ( index == sizeof( ezbus_crc_t ) )
-                    {
-                        switch ( ezbus_packet_type( packet ) )
-                        {
-                            case packet_type_parcel: 
-                            {
-                               /* variable parcel data transport size... */
-                                ezbus_parcel_t* parcel = ezbus_packet_get_parcel( packet );
-                                index = ezbus_private_recv( port, &parcel->size, 0, sizeof(parcel->size) );
-                                if ( index == sizeof(uint16_t) )
-                                {
-                                    if ( parcel->size <= EZBUS_PARCEL_DATA_LN  )
-                                    {
-                                        index = ezbus_private_recv( port, parcel->bytes, 0, parcel->size );
-                                        if ( index == parcel->size )
-                                        {
-                                            ezbus_packet_data_flip( packet );
-                                            err = ezbus_packet_data_valid_crc( packet ) ? EZBUS_ERR_OKAY : EZBUS_ERR_DATA_CRC;
-                                        }
-                                        else
-                                        {
-                                            err = EZBUS_ERR_TIMEOUT;
-                                            EZBUS_LOG( EZBUS_LOG_PORT, "parcel %s", ezbus_fault_str(err) );
-                                        }
-                                    }
-                                    else
-                                    {
-                                        err = EZBUS_ERR_RANGE;
-                                        EZBUS_LOG( EZBUS_LOG_PORT, "parcel %s", ezbus_fault_str(err) );
-                                    }
-                                    
-                                }
-                                else
-                                {
-                                    err = EZBUS_ERR_RANGE;
-                                    EZBUS_LOG( EZBUS_LOG_PORT, "parcel %s", ezbus_fault_str(err) );
-                                }
-                                
-                            }
-                            break;
-                            case packet_type_take_token:
-                            case packet_type_give_token:
-                            case packet_type_speed:
-                            case packet_type_pause:
-                            {
-                                index = ezbus_private_recv( port, ezbus_packet_data( packet ), 0, ezbus_packet_data_tx_size( packet ) );
-                                if ( index == ezbus_packet_data_tx_size( packet ) )
-                                {
-                                    ezbus_packet_data_flip( packet );
-                                    err = ezbus_packet_data_valid_crc( packet ) ? EZBUS_ERR_OKAY : EZBUS_ERR_DATA_CRC;
-                                }
-                                else
-                                {
-                                    err = EZBUS_ERR_TIMEOUT;
-                                    EZBUS_LOG( EZBUS_LOG_PORT, "parcel %s", ezbus_fault_str(err) );
-                                }
-                            }
-                            break;
-                            default:
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        err = EZBUS_ERR_DATA_CRC;
-                        EZBUS_LOG( EZBUS_LOG_PORT, "%s", ezbus_fault_str(err) );
-                    }
-                }
-                else
-                {
-                    err = EZBUS_ERR_OKAY;
-                }
+                ezbus_crc_init( &port->rx_crc );
+                ezbus_port_rx_field( port, port_rx_state_header, &packet->header, sizeof( packet->header.data ) );
             }
             else
             {
-                err = EZBUS_ERR_HEADER_CRC;
-                EZBUS_LOG( EZBUS_LOG_PORT, "%s", ezbus_fault_str(err) );
+                ++port->rx_tail;
             }
         }
         else
+        {
+            uint16_t count = port->rx_size - port->rx_index;
+            uint8_t* src   = &port->rx_buffer[ port->rx_tail ];
+
+            if ( count > port->rx_head - port->rx_tail )
+            {
+                count = port->rx_head - port->rx_tail;
+            }
+            ezbus_platform.callback_memcpy( &port->rx_dst[ port->rx_index ], src, count );
+            if ( port->rx_state != port_rx_state_header_crc && port->rx_state != port_rx_state_data_crc )
+            {
+                ezbus_crc( &port->rx_crc, src, count );
+            }
+            port->rx_tail  += count;
+            port->rx_index += count;
+
+            if ( port->rx_index == port->rx_size )
+            {
+                err = ezbus_port_rx_field_done( port, packet );
+            }
+        }
+    }
+    return err;
+}
+
+extern EZBUS_ERR ezbus_port_recv( ezbus_port_t* port, ezbus_packet_t* packet )
+{
+    EZBUS_ERR err = ezbus_port_rx_parse( port, packet );
+
+    while ( err == EZBUS_ERR_NOTREADY && ezbus_port_rx_fill( port ) )
+    {
+        err = ezbus_port_rx_parse( port, packet );
+    }
+
+    if ( err == EZBUS_ERR_NOTREADY )
+    {
+        if ( port->rx_state != port_rx_state_seek && (ezbus_platform.callback_get_ms_ticks() - port->rx_tick) > port->packet_timeout )
         {
             err = EZBUS_ERR_TIMEOUT;
-            EZBUS_LOG( EZBUS_LOG_PORT, "header %s", ezbus_fault_str(err) );
+            EZBUS_LOG( EZBUS_LOG_PORT, "state %d %s", port->rx_state, ezbus_fault_str(err) );
+            port->rx_state = port_rx_state_seek;
         }
+        return err;
     }
 
+    port->rx_state = port_rx_state_seek;
+
     if ( err == EZBUS_ERR_OKAY )
     {
         /** @note In case of hardware loopback, discard our own packets */ 
@@ -216,10 +264,49 @@ extern EZBUS_ERR ezbus_port_recv( ezbus_port_t* port, ezbus_packet_t* packet )
             ezbus_packet_dump( "RX:", packet, ezbus_packet_tx_size( packet ) );
         }
     }
+    else if ( err == EZBUS_ERR_MISMATCH )
+    {
+        /* a frame type which carries no data this receiver understands */
+        err = EZBUS_ERR_NOTREADY;
+    }
+    else
+    {
+        EZBUS_LOG( EZBUS_LOG_PORT, "%s", ezbus_fault_str(err) );
+    }
 
     return err;
 }
 
+extern ezbus_ms_tick_t ezbus_port_next_expiry( ezbus_port_t* port )
+{
+    ezbus_ms_tick_t elapsed;
+
+    if ( port->rx_tail < port->rx_head )
+    {
+        return 0;
+    }
+    if ( port->rx_state == port_rx_state_seek )
+    {
+        return EZBUS_TIMER_FOREVER;
+    }
+    elapsed = ezbus_platform.callback_get_ms_ticks() - port->rx_tick;
+    return ( elapsed > port->packet_timeout ) ? 0 : ( port->packet_timeout - elapsed ) + 1;
+}
+
+extern void ezbus_port_set_wake_callback( ezbus_port_t* port, void (*callback)(ezbus_port_t*,void*), void* arg )
+{
+    port->wake_callback = callback;
+    port->wake_arg      = arg;
+}
+
+extern void ezbus_port_wake( ezbus_port_t* port )
+{
+    if ( port->wake_callback )
+    {
+        port->wake_callback( port, port->wake_arg );
+    }
+}
+
 void ezbus_port_close( ezbus_port_t* port )
 {
     port->callback_close(port);
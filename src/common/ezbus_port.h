@@ -29,12 +29,26 @@ extern "C" {
 #include <ezbus_types.h>
 #include <ezbus_packet.h>
 
+/**
+ * @brief Frame parser state, @ref ezbus_port_recv() resumes from here with each new batch of bytes.
+ */
+typedef enum
+{
+    port_rx_state_seek=0,       /* discarding bytes up to a lead-in mark */
+    port_rx_state_header,
+    port_rx_state_header_crc,
+    port_rx_state_data_crc,
+    port_rx_state_parcel_size,
+    port_rx_state_data,
+} ezbus_port_rx_state_t;
+
 typedef struct _ezbus_port
 {
     void*           private;
 
     int                     (*callback_open)        (struct _ezbus_port* port );
     int                     (*callback_send)        (struct _ezbus_port* port, void* bytes, size_t size );
+    /* Copy up to 'size' bytes which have already arrived, without waiting, return the count */
     int                     (*callback_recv)        (struct _ezbus_port* port, void* bytes, size_t size );
     void                    (*callback_close)       (struct _ezbus_port* port );
     void                    (*callback_flush)       (struct _ezbus_port* port );
@@ -55,13 +69,53 @@ typedef struct _ezbus_port
     
     ezbus_address_t self_address;
 
+    ezbus_port_rx_state_t   rx_state;
+    uint8_t*                rx_dst;             /* where the current field is being stored */
+    uint16_t                rx_index;           /* bytes of the current field received */
+    uint16_t                rx_size;            /* bytes in the current field */
+    ezbus_crc_t             rx_crc;             /* running CRC over the current frame section */
+    ezbus_ms_tick_t         rx_tick;            /* arrival of the last byte */
+    uint16_t                rx_head;            /* rx_buffer[rx_tail..rx_head-1] are yet to be parsed */
+    uint16_t                rx_tail;
+    uint8_t                 rx_buffer[EZBUS_PORT_RX_LN];
+
+    void                    (*wake_callback)        (struct _ezbus_port* port, void* arg );
+    void*                   wake_arg;
+
 } ezbus_port_t;
 
 extern int                      ezbus_port_setup                    ( ezbus_port_t* port );
 extern void                     ezbus_port_dispose                  ( ezbus_port_t* port );
 extern EZBUS_ERR                ezbus_port_open                     ( ezbus_port_t* port );
 extern EZBUS_ERR                ezbus_port_send                     ( ezbus_port_t* port, ezbus_packet_t* packet );
+
+/**
+ * @brief Parse whatever bytes have arrived into 'packet', and return without waiting for the rest.
+ *          A frame may span any number of calls, so the same 'packet' must be passed until the
+ *          frame completes.
+ * @return EZBUS_ERR_OKAY when a frame has completed, EZBUS_ERR_NOTREADY while one is incomplete,
+ *          or else the fault which caused the frame to be discarded.
+ */
 extern EZBUS_ERR                ezbus_port_recv                     ( ezbus_port_t* port, ezbus_packet_t* packet );
+
+/**
+ * @brief The number of milli-seconds until the receiver must run without new bytes arriving.
+ * @return 0 when bytes are waiting to be parsed, the time remaining of the inter-byte timeout
+ *          while a frame is incomplete, else EZBUS_TIMER_FOREVER.
+ */
+extern ezbus_ms_tick_t          ezbus_port_next_expiry              ( ezbus_port_t* port );
+
+/**
+ * @brief Register a function to be invoked by @ref ezbus_port_wake(), ex. to post a semaphore or
+ *          write an eventfd, which the host loop sleeps on between calls to @ref ezbus_run().
+ */
+extern void                     ezbus_port_set_wake_callback        ( ezbus_port_t* port, void (*callback)(ezbus_port_t*,void*), void* arg );
+
+/**
+ * @brief Invoked by the port driver when bytes arrive, may be called from interrupt context.
+ */
+extern void                     ezbus_port_wake                     ( ezbus_port_t* port );
+
 extern void                     ezbus_port_close                    ( ezbus_port_t* port );
 extern void                     ezbus_port_drain                    ( ezbus_port_t* port );
 extern int                      ezbus_port_getch                    ( ezbus_port_t* port );
@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#include <ezbus_ring.h>
+#include <ezbus_platform.h>
+
+extern EZBUS_ERR ezbus_ring_init( ezbus_ring_t* ring, void* records, size_t record_size, uint32_t count )
+{
+    if ( count == 0 || ( count & (count-1) ) )
+    {
+        return EZBUS_ERR_PARAM;
+    }
+    ezbus_platform.callback_memset( ring, 0, sizeof(ezbus_ring_t) );
+    ring->records     = (uint8_t*)records;
+    ring->record_size = record_size;
+    ring->count       = count;
+    return EZBUS_ERR_OKAY;
+}
+
+extern void* ezbus_ring_reserve( ezbus_ring_t* ring )
+{
+    if ( ring->head - ring->tail_cache == ring->count )
+    {
+        /* only look at the consumer's cache line when the ring appears full */
+        ring->tail_cache = __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE );
+        if ( ring->head - ring->tail_cache == ring->count )
+        {
+            return NULL;
+        }
+    }
+    return &ring->records[ ( ring->head & (ring->count-1) ) * ring->record_size ];
+}
+
+extern void ezbus_ring_commit( ezbus_ring_t* ring )
+{
+    /* the record contents are published before the index */
+    __atomic_store_n( &ring->head, ring->head+1, __ATOMIC_RELEASE );
+}
+
+extern uint32_t ezbus_ring_free( ezbus_ring_t* ring )
+{
+    ring->tail_cache = __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE );
+    return ring->count - ( ring->head - ring->tail_cache );
+}
+
+extern void* ezbus_ring_peek( ezbus_ring_t* ring )
+{
+    if ( ring->tail == ring->head_cache )
+    {
+        /* only look at the producer's cache line when the ring appears empty */
+        ring->head_cache = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+        if ( ring->tail == ring->head_cache )
+        {
+            return NULL;
+        }
+    }
+    return &ring->records[ ( ring->tail & (ring->count-1) ) * ring->record_size ];
+}
+
+extern void ezbus_ring_release( ezbus_ring_t* ring )
+{
+    /* the record has been read before it is handed back to the producer */
+    __atomic_store_n( &ring->tail, ring->tail+1, __ATOMIC_RELEASE );
+}
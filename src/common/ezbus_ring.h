@@ -0,0 +1,80 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#ifndef EZBUS_RING_H_
+#define EZBUS_RING_H_
+
+#include <ezbus_types.h>
+#include <ezbus_const.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A lock-free ring of fixed size records, for exactly one producer thread and one consumer
+ *          thread. The producer owns head, the consumer owns tail, each only reads the other's 
+ *          index, so no lock is taken on either side. Records are filled and drained in place.
+ */
+typedef struct _ezbus_ring_t
+{
+    /* producer side */
+    uint32_t            head __attribute__((aligned(EZBUS_CACHE_LINE)));
+    uint32_t            tail_cache;         /* last tail seen by the producer */
+    /* consumer side */
+    uint32_t            tail __attribute__((aligned(EZBUS_CACHE_LINE)));
+    uint32_t            head_cache;         /* last head seen by the consumer */
+    /* fixed at init */
+    uint8_t*            records __attribute__((aligned(EZBUS_CACHE_LINE)));
+    size_t              record_size;
+    uint32_t            count;              /* a power of 2 */
+} ezbus_ring_t;
+
+/**
+ * @brief Initialize a ring over caller storage of count * record_size bytes.
+ * @return EZBUS_ERR_PARAM when count is not a power of 2.
+ */
+extern EZBUS_ERR    ezbus_ring_init     ( ezbus_ring_t* ring, void* records, size_t record_size, uint32_t count );
+
+/**
+ * @brief Producer, the next free record to fill, or NULL when the ring is full.
+ *          The record becomes visible to the consumer on @ref ezbus_ring_commit().
+ */
+extern void*        ezbus_ring_reserve  ( ezbus_ring_t* ring );
+extern void         ezbus_ring_commit   ( ezbus_ring_t* ring );
+
+/**
+ * @brief Producer, the number of records which may be reserved and committed without blocking.
+ */
+extern uint32_t     ezbus_ring_free     ( ezbus_ring_t* ring );
+
+/**
+ * @brief Consumer, the oldest committed record, or NULL when the ring is empty.
+ *          The record remains the consumer's to read (and modify) until @ref ezbus_ring_release().
+ */
+extern void*        ezbus_ring_peek     ( ezbus_ring_t* ring );
+extern void         ezbus_ring_release  ( ezbus_ring_t* ring );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EZBUS_RING_H_ */
@@ -0,0 +1,67 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#include <ezbus_rtt.h>
+#include <ezbus_platform.h>
+
+extern void ezbus_rtt_init( ezbus_rtt_t* rtt )
+{
+    ezbus_platform.callback_memset( rtt, 0, sizeof(ezbus_rtt_t) );
+}
+
+extern void ezbus_rtt_sample( ezbus_rtt_t* rtt, ezbus_ms_tick_t sample )
+{
+    if ( sample > EZBUS_RTT_SAMPLE_MAX )
+    {
+        sample = EZBUS_RTT_SAMPLE_MAX;
+    }
+    if ( !rtt->measured )
+    {
+        rtt->measured = true;
+        rtt->avg = sample << 3;
+        rtt->var = sample << 1;
+    }
+    else
+    {
+        /* avg += err/8, var += (|err| - var)/4, in fixed point */
+        int32_t err = (int32_t)sample - (int32_t)( rtt->avg >> 3 );
+        rtt->avg += err;
+        if ( err < 0 )
+        {
+            err = -err;
+        }
+        rtt->var += err - (int32_t)( rtt->var >> 2 );
+    }
+}
+
+extern bool ezbus_rtt_measured( const ezbus_rtt_t* rtt )
+{
+    return rtt->measured;
+}
+
+extern ezbus_ms_tick_t ezbus_rtt_timeout( const ezbus_rtt_t* rtt )
+{
+    if ( !rtt->measured )
+    {
+        return 0;
+    }
+    return ( rtt->avg >> 3 ) + rtt->var + 1;
+}
@@ -0,0 +1,56 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#ifndef EZBUS_RTT_H_
+#define EZBUS_RTT_H_
+
+#include <ezbus_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EZBUS_RTT_SAMPLE_MAX    8191            /* Longest sample taken, ms, keeps the fixed point in 16 bits */
+
+/**
+ * @brief A smoothed round trip time and its mean deviation, after Jacobson and Karels.
+ */
+typedef struct
+{
+    uint16_t    avg;                            /* smoothed time, ms * 8 */
+    uint16_t    var;                            /* smoothed mean deviation, ms * 4 */
+    bool        measured;                       /* at least one sample has been taken */
+} ezbus_rtt_t;
+
+extern void             ezbus_rtt_init          ( ezbus_rtt_t* rtt );
+extern void             ezbus_rtt_sample        ( ezbus_rtt_t* rtt, ezbus_ms_tick_t sample );
+extern bool             ezbus_rtt_measured      ( const ezbus_rtt_t* rtt );
+/**
+ * @brief The time beyond which a sample would be late, the smoothed time plus four mean deviations, ms.
+ * @return 0 until a sample has been taken.
+ */
+extern ezbus_ms_tick_t  ezbus_rtt_timeout       ( const ezbus_rtt_t* rtt );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EZBUS_RTT_H_ */
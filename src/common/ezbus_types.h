@@ -30,4 +30,6 @@
 
 typedef uint32_t ezbus_ms_tick_t;     
 
+#define EZBUS_TIMER_FOREVER         ((ezbus_ms_tick_t)0xFFFFFFFF)
+
 #endif /* EZBUS_TYPES_H_ */
@@ -33,6 +33,11 @@ extern void ezbus_run( ezbus_t* ezbus )
     ezbus_mac_run( &ezbus->mac );
 }
 
+extern ezbus_ms_tick_t ezbus_next_wakeup( ezbus_t* ezbus )
+{
+    return ezbus_mac_next_wakeup( &ezbus->mac );
+}
+
 extern struct _ezbus_mac_t* ezbus_mac( ezbus_t* ezbus )
 {
     return &ezbus->mac;
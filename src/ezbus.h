@@ -94,10 +94,21 @@ typedef struct _ezbus_t
 extern void ezbus_init   ( ezbus_t* ezbus, ezbus_port_t* port );
 
 /**
- * @brief Run the ezbus protocol. Must be called continuously, in a non-blocking loop. 
+ * @brief Run the ezbus protocol. Must be called continuously, in a non-blocking loop, or else
+ *          whenever @ref ezbus_next_wakeup() falls due, or the port signals that bytes have arrived, 
+ *          see @ref ezbus_port_set_wake_callback().
  */
 extern void ezbus_run( ezbus_t* ezbus );
 
+/**
+ * @brief The earliest timer, pause or receive deadline, in milli-seconds from now. The host may
+ *          sleep (ex. poll(), epoll_wait(), or an RTOS wait) for up to this long, or until the port
+ *          wakes it, before the next call to @ref ezbus_run().
+ * @return 0 when @ref ezbus_run() has work to do now, EZBUS_TIMER_FOREVER when only arriving bytes
+ *          can create work.
+ */
+extern ezbus_ms_tick_t ezbus_next_wakeup( ezbus_t* ezbus );
+
 /**
  * @brief Retrieve the ezbus mac from an @ref ezbus_t struct.
  * @param ezbus A pointer to an initialized @ref ezbus_t structure. see: @ref ezbus_init().
@@ -53,6 +53,36 @@ void ezbus_mac_run( ezbus_mac_t* mac )
     ezbus_mac_transmitter_run       ( mac );
 }
 
+/**
+ * @brief The number of milli-seconds which may pass before @ref ezbus_mac_run() must be invoked,
+ *          unless bytes arrive in the meantime. 0 means there is work to do now.
+ */
+extern ezbus_ms_tick_t ezbus_mac_next_wakeup( ezbus_mac_t* mac )
+{
+    ezbus_ms_tick_t next;
+    ezbus_ms_tick_t expiry;
+
+    if ( ezbus_mac_receiver_get_state( mac ) != receiver_state_empty    ||
+         ezbus_mac_transmitter_count( mac ) != 0                        ||
+         ezbus_mac_transmitter_get_state( mac ) != transmitter_state_empty ||
+         ezbus_mac_arbiter_pause_get_state( mac ) != mac_arbiter_state_pause_stopped ||
+         !ezbus_mac_arbiter_idle( mac ) )
+    {
+        return 0;
+    }
+
+    next = ezbus_mac_timer_next_expiry( mac );
+    if ( next && (expiry = ezbus_mac_pause_next_expiry( mac )) < next )
+    {
+        next = expiry;
+    }
+    if ( next && (expiry = ezbus_port_next_expiry( ezbus_mac_get_port( mac ) )) < next )
+    {
+        next = expiry;
+    }
+    return next;
+}
+
 extern inline ezbus_port_t* ezbus_mac_get_port(ezbus_mac_t* mac) 
 {
     return mac->port;
@@ -95,7 +125,7 @@ extern ezbus_mac_token_t* ezbus_mac_get_token(ezbus_mac_t* mac)
 
 extern ezbus_packet_t* ezbus_mac_get_transmitter_packet(ezbus_mac_t* mac)
 {
-    return &mac->transmitter.packet;
+    return mac->transmitter.frame[ mac->transmitter.order[0] ];
 }
 
 extern ezbus_packet_t* ezbus_mac_get_receiver_packet(ezbus_mac_t* mac)
@@ -113,4 +143,9 @@ extern ezbus_mac_timer_t* ezbus_mac_get_timer(ezbus_mac_t* mac)
     return &mac->timer;
 }
 
+extern ezbus_socket_table_t* ezbus_mac_get_sockets(ezbus_mac_t* mac)
+{
+    return &mac->sockets;
+}
+
 
@@ -35,6 +35,7 @@ typedef struct _ezbus_mac_arbiter_transmit_t ezbus_mac_arbiter_transmit_t;
 typedef struct _ezbus_mac_token_t            ezbus_mac_token_t;
 typedef struct _ezbus_mac_pause_t            ezbus_mac_pause_t;
 typedef struct _ezbus_mac_timer_t            ezbus_mac_timer_t;
+typedef struct _ezbus_socket_table_t         ezbus_socket_table_t;
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,6 +43,7 @@ extern "C" {
 
 extern void                          ezbus_mac_init                     (ezbus_mac_t* mac, ezbus_port_t* port);
 extern void                          ezbus_mac_run                      (ezbus_mac_t* mac);
+extern ezbus_ms_tick_t               ezbus_mac_next_wakeup              (ezbus_mac_t* mac);
 extern ezbus_port_t*                 ezbus_mac_get_port                 (ezbus_mac_t* mac);
 extern ezbus_mac_peers_t*            ezbus_mac_get_peers                (ezbus_mac_t* mac);
 extern ezbus_mac_transmitter_t*      ezbus_mac_get_transmitter          (ezbus_mac_t* mac);
@@ -54,6 +56,7 @@ extern ezbus_packet_t*               ezbus_mac_get_transmitter_packet   (ezbus_m
 extern ezbus_packet_t*               ezbus_mac_get_receiver_packet      (ezbus_mac_t* mac);
 extern ezbus_mac_pause_t*            ezbus_mac_get_pause                (ezbus_mac_t* mac);
 extern ezbus_mac_timer_t*            ezbus_mac_get_timer                (ezbus_mac_t* mac);
+extern ezbus_socket_table_t*         ezbus_mac_get_sockets              (ezbus_mac_t* mac);
 
 #ifdef __cplusplus
 }
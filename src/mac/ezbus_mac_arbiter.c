@@ -34,12 +34,15 @@
 #include <ezbus_platform.h>
 
 #define ezbus_mac_arbiter_transmitter_ready(mac)                            \
-            ( ezbus_mac_transmitter_empty((mac)) &&                         \
-            !ezbus_mac_arbiter_transmit_busy((mac)) )
+            ( ezbus_mac_transmitter_available((mac)) )
+
+#define ezbus_mac_arbiter_token_spent(mac)                                  \
+            ( arbiter->token_sent + ezbus_mac_transmitter_bytes((mac)) >=   \
+              ezbus_mac_arbiter_get_token_budget((mac)) )
 
 #define ezbus_mac_arbiter_ready_to_give_token(mac)                          \
-            ( ezbus_mac_arbiter_transmitter_ready((mac)) &&                 \
-            arbiter->token_hold++ > EZBUS_TOKEN_HOLD_CYCLES )
+            ( ezbus_mac_transmitter_empty((mac)) &&                         \
+            ( arbiter->token_idle || ezbus_mac_arbiter_token_spent((mac)) ) )
 
 #define ezbus_mac_arbiter_give_token(mac)                                   \
             {                                                               \
@@ -47,30 +50,6 @@
                 ezbus_mac_token_relinquish((mac));                          \
             }  
 
-#define ezbus_mac_arbiter_ready_to_ack(mac)                                 \
-            ( ezbus_mac_arbiter_transmitter_ready((mac)) &&                 \
-            arbiter->rx_ack_pend )
-
-#define ezbus_mac_arbiter_ready_to_nack(mac)                                \
-            ( ezbus_mac_arbiter_transmitter_ready((mac)) &&                 \
-            arbiter->rx_nack_pend )
-
-#define ezbus_mac_arbiter_send_ack_parcel(mac)                              \
-            {                                                               \
-                ezbus_mac_arbiter_ack_parcel( (mac), arbiter->rx_ack_seq,   \
-                                            &arbiter->rx_ack_address );     \
-                arbiter->rx_ack_pend=false;                                 \
-                arbiter->rx_ack_seq=0;                                      \
-            }
-
-#define ezbus_mac_arbiter_send_nack_parcel(mac)                             \
-            {                                                               \
-                ezbus_mac_arbiter_nack_parcel( (mac), arbiter->rx_nack_seq, \
-                                            &arbiter->rx_nack_address );    \
-                arbiter->rx_nack_pend=false;                                \
-                arbiter->rx_nack_seq=0;                                     \
-            }
-
 /****************************************************************************/
 
 #define ezbus_mac_boot1_set_emit_count(boot,c)   ((boot)->emit_count=(c))
@@ -135,8 +114,9 @@ static void ezbus_mac_boot2_timeout_timer_callback          ( ezbus_timer_t* tim
 
 /* parcel / token synchronization */
 static bool ezbus_mac_arbiter_receive_token                 ( ezbus_mac_t* mac, ezbus_packet_t* packet );
-static void ezbus_mac_arbiter_ack_parcel                    ( ezbus_mac_t* mac, uint8_t seq, ezbus_address_t* address );
-static void ezbus_mac_arbiter_nack_parcel                   ( ezbus_mac_t* mac, uint8_t seq, ezbus_address_t* address );
+static bool ezbus_mac_arbiter_ack_parcel                    ( ezbus_mac_t* mac, ezbus_mac_arbiter_ack_t* ack );
+static void ezbus_mac_arbiter_send_acks                     ( ezbus_mac_t* mac );
+static bool ezbus_mac_arbiter_ack_pending                   ( ezbus_mac_t* mac );
 
 /* senders */
 static void ezbus_mac_boot2_reply_timer_callback            ( ezbus_timer_t* timer, void* arg );
@@ -165,11 +145,14 @@ static void do_mac_packet_type_boot2_ak                     ( ezbus_mac_t* mac,
 
 /* misc... */
 static void ezbus_mac_arbiter_set_token_age                 ( ezbus_mac_t* mac, uint16_t age );
+static void ezbus_mac_arbiter_token_hold_start              ( ezbus_mac_t* mac );
 
 extern void  ezbus_mac_arbiter_init ( ezbus_mac_t* mac )
 {
     ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    uint8_t token_weight = arbiter->token_weight;
     ezbus_platform.callback_memset( arbiter, 0 , sizeof( ezbus_mac_arbiter_t) );
+    arbiter->token_weight = token_weight ? token_weight : EZBUS_TOKEN_WEIGHT;
     ezbus_mac_boot0_init( mac );
     ezbus_mac_boot1_init( mac );
     ezbus_mac_boot2_init( mac );
@@ -268,14 +251,15 @@ extern ezbus_mac_arbiter_state_t ezbus_mac_arbiter_get_state ( ezbus_mac_t* mac
 
 extern void ezbus_mac_arbiter_bootstrap ( ezbus_mac_t* mac)
 {
-    ezbus_packet_t packet;
+    ezbus_packet_control_t control;
+    ezbus_packet_t* packet = ezbus_packet_control( &control );
 
-    ezbus_packet_init           ( &packet );
-    ezbus_packet_set_type       ( &packet, packet_type_reset );
-    ezbus_packet_set_src        ( &packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
-    ezbus_packet_set_dst        ( &packet, &ezbus_broadcast_address );
+    ezbus_packet_init           ( packet );
+    ezbus_packet_set_type       ( packet, packet_type_reset );
+    ezbus_packet_set_src        ( packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    ezbus_packet_set_dst        ( packet, &ezbus_broadcast_address );
 
-    ezbus_mac_transmitter_put( mac, &packet );
+    ezbus_mac_transmitter_put( mac, packet );
 
     ezbus_mac_arbiter_init( mac );
 }
@@ -516,18 +500,19 @@ static void ezbus_mac_boot1_timer_callback( ezbus_timer_t* timer, void* arg )
 
     if ( ezbus_mac_transmitter_empty( mac ) )
     {
-        ezbus_packet_t packet;
+        ezbus_packet_control_t control;
+        ezbus_packet_t* packet = ezbus_packet_control( &control );
 
-        ezbus_packet_init           ( &packet );
-        ezbus_packet_set_type       ( &packet, packet_type_boot1 );
-        ezbus_packet_set_seq        ( &packet, ezbus_mac_boot1_get_seq( mac ) );
-        ezbus_packet_set_dst_socket ( &packet, EZBUS_SOCKET_ANY );
-        ezbus_packet_set_src_socket ( &packet, EZBUS_SOCKET_ANY );
-        ezbus_packet_set_src        ( &packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+        ezbus_packet_init           ( packet );
+        ezbus_packet_set_type       ( packet, packet_type_boot1 );
+        ezbus_packet_set_seq        ( packet, ezbus_mac_boot1_get_seq( mac ) );
+        ezbus_packet_set_dst_socket ( packet, EZBUS_SOCKET_ANY );
+        ezbus_packet_set_src_socket ( packet, EZBUS_SOCKET_ANY );
+        ezbus_packet_set_src        ( packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
 
-        EZBUS_LOG( EZBUS_LOG_BOOT1, "%cboot1> %s %3d | ", ezbus_mac_token_acquired(mac)?'*':' ', ezbus_address_string( ezbus_packet_src( &packet ) ), ezbus_packet_seq( &packet ) );
+        EZBUS_LOG( EZBUS_LOG_BOOT1, "%cboot1> %s %3d | ", ezbus_mac_token_acquired(mac)?'*':' ', ezbus_address_string( ezbus_packet_src( packet ) ), ezbus_packet_seq( packet ) );
 
-        ezbus_mac_transmitter_put( mac, &packet );
+        ezbus_mac_transmitter_put( mac, packet );
     }
     ezbus_mac_boot1_inc_emit_count( boot1 );
     ezbus_mac_arbiter_set_state( mac, mac_arbiter_state_boot1_cycle_start );
@@ -565,18 +550,19 @@ static void do_mac_packet_type_boot1( ezbus_mac_t* mac, ezbus_packet_t* packet )
         ezbus_mac_boot1_state_t* boot1 = &arbiter->boot1_state;
         if ( ezbus_mac_transmitter_empty( mac ) )
         {
-            ezbus_packet_t packet;
+            ezbus_packet_control_t control;
+            ezbus_packet_t* packet = ezbus_packet_control( &control );
 
-            ezbus_packet_init           ( &packet );
-            ezbus_packet_set_type       ( &packet, packet_type_boot1 );
-            ezbus_packet_set_seq        ( &packet, ezbus_mac_boot1_get_seq( mac ) );
-            ezbus_packet_set_dst_socket ( &packet, EZBUS_SOCKET_ANY );
-            ezbus_packet_set_src_socket ( &packet, EZBUS_SOCKET_ANY );
-            ezbus_packet_set_src        ( &packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+            ezbus_packet_init           ( packet );
+            ezbus_packet_set_type       ( packet, packet_type_boot1 );
+            ezbus_packet_set_seq        ( packet, ezbus_mac_boot1_get_seq( mac ) );
+            ezbus_packet_set_dst_socket ( packet, EZBUS_SOCKET_ANY );
+            ezbus_packet_set_src_socket ( packet, EZBUS_SOCKET_ANY );
+            ezbus_packet_set_src        ( packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
 
-            EZBUS_LOG( EZBUS_LOG_BOOT1, "%cboot1> %s %3d | ", ezbus_mac_token_acquired(mac)?'*':' ', ezbus_address_string( ezbus_packet_src( &packet ) ), ezbus_packet_seq( &packet ) );
+            EZBUS_LOG( EZBUS_LOG_BOOT1, "%cboot1> %s %3d | ", ezbus_mac_token_acquired(mac)?'*':' ', ezbus_address_string( ezbus_packet_src( packet ) ), ezbus_packet_seq( packet ) );
 
-            ezbus_mac_transmitter_put( mac, &packet );
+            ezbus_mac_transmitter_put( mac, packet );
             
             ezbus_mac_arbiter_set_state( mac, mac_arbiter_state_boot1_cycle_start );
 
@@ -743,18 +729,19 @@ static void do_mac_arbiter_state_boot2_cycle_stop( ezbus_mac_t* mac )
     ezbus_timer_stop( &boot2->timeout_timer );
     if ( ezbus_mac_transmitter_empty( mac ) )
     {
-        ezbus_packet_t packet;
+        ezbus_packet_control_t control;
+        ezbus_packet_t* packet = ezbus_packet_control( &control );
 
         EZBUS_LOG( EZBUS_LOG_BOOT2, "%c seq %d", ezbus_mac_token_acquired(mac)?'*':' ', ezbus_mac_arbiter_get_boot2_seq( mac ) );
 
-        ezbus_packet_init           ( &packet );
-        ezbus_packet_set_type       ( &packet, packet_type_boot2_rq );
-        ezbus_packet_set_dst_socket ( &packet, EZBUS_SOCKET_ANY );
-        ezbus_packet_set_src_socket ( &packet, EZBUS_SOCKET_ANY );
-        ezbus_packet_set_seq        ( &packet, ezbus_mac_arbiter_get_boot2_seq( mac ) );
-        ezbus_packet_set_src        ( &packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+        ezbus_packet_init           ( packet );
+        ezbus_packet_set_type       ( packet, packet_type_boot2_rq );
+        ezbus_packet_set_dst_socket ( packet, EZBUS_SOCKET_ANY );
+        ezbus_packet_set_src_socket ( packet, EZBUS_SOCKET_ANY );
+        ezbus_packet_set_seq        ( packet, ezbus_mac_arbiter_get_boot2_seq( mac ) );
+        ezbus_packet_set_src        ( packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
 
-        ezbus_mac_transmitter_put( mac, &packet );
+        ezbus_mac_transmitter_put( mac, packet );
     }
     ezbus_mac_arbiter_set_state( mac, mac_arbiter_state_boot2_cycle_start );
 }
@@ -770,6 +757,7 @@ static void do_mac_arbiter_state_boot2_finished( ezbus_mac_t* mac )
     ezbus_timer_stop( &boot2->timeout_timer );
     ezbus_mac_arbiter_rst_boot2_cycles( mac );
     ezbus_mac_arbiter_set_state( mac, mac_arbiter_state_service_start );
+    ezbus_mac_arbiter_token_hold_start( mac );
     ezbus_mac_token_acquire( mac );
     ezbus_mac_token_reset( mac );
 }
@@ -807,7 +795,8 @@ static void ezbus_mac_boot2_timeout_timer_callback( ezbus_timer_t* timer, void*
 
 static void ezbus_mac_boot2_reply_timer_callback( ezbus_timer_t* timer, void* arg )
 {
-    ezbus_packet_t tx_packet;
+    ezbus_packet_control_t tx_control;
+    ezbus_packet_t* tx_packet = ezbus_packet_control( &tx_control );
     ezbus_mac_t* mac = (ezbus_mac_t*)arg;
     ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet( mac );
 
@@ -815,15 +804,15 @@ static void ezbus_mac_boot2_reply_timer_callback( ezbus_timer_t* timer, void* ar
 
     EZBUS_LOG( EZBUS_LOG_BOOT2, "%c seq %d", ezbus_mac_token_acquired(mac)?'*':' ', ezbus_mac_arbiter_get_boot2_seq( mac ) );
 
-    ezbus_packet_init           ( &tx_packet );
-    ezbus_packet_set_type       ( &tx_packet, packet_type_boot2_rp );
-    ezbus_packet_set_dst_socket ( &tx_packet, EZBUS_SOCKET_ANY  );
-    ezbus_packet_set_src_socket ( &tx_packet, EZBUS_SOCKET_ANY  );
-    ezbus_packet_set_seq        ( &tx_packet, ezbus_packet_seq( rx_packet ) );
-    ezbus_packet_set_src        ( &tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
-    ezbus_packet_set_dst        ( &tx_packet, ezbus_packet_src( rx_packet ) );
+    ezbus_packet_init           ( tx_packet );
+    ezbus_packet_set_type       ( tx_packet, packet_type_boot2_rp );
+    ezbus_packet_set_dst_socket ( tx_packet, EZBUS_SOCKET_ANY  );
+    ezbus_packet_set_src_socket ( tx_packet, EZBUS_SOCKET_ANY  );
+    ezbus_packet_set_seq        ( tx_packet, ezbus_packet_seq( rx_packet ) );
+    ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    ezbus_packet_set_dst        ( tx_packet, ezbus_packet_src( rx_packet ) );
 
-    ezbus_mac_transmitter_put( mac, &tx_packet );
+    ezbus_mac_transmitter_put( mac, tx_packet );
 }
 
 /*****************************************************************************
@@ -910,21 +899,22 @@ static void do_mac_packet_type_boot2_ak( ezbus_mac_t* mac, ezbus_packet_t* packe
 
 static void ezbus_mac_arbiter_boot2_send_ack( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
-    ezbus_packet_t tx_packet;
+    ezbus_packet_control_t tx_control;
+    ezbus_packet_t* tx_packet = ezbus_packet_control( &tx_control );
     ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
     ezbus_mac_boot2_state_t* boot2 = &arbiter->boot2_state;
 
     ezbus_timer_stop( &boot2->reply_timer );
 
-    ezbus_packet_init           ( &tx_packet );
-    ezbus_packet_set_type       ( &tx_packet, packet_type_boot2_ak );
-    ezbus_packet_set_dst_socket ( &tx_packet, EZBUS_SOCKET_ANY  );
-    ezbus_packet_set_src_socket ( &tx_packet, EZBUS_SOCKET_ANY  );
-    ezbus_packet_set_seq        ( &tx_packet, ezbus_packet_seq( packet ) );
-    ezbus_packet_set_src        ( &tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
-    ezbus_packet_set_dst        ( &tx_packet, ezbus_packet_src( packet ) );
+    ezbus_packet_init           ( tx_packet );
+    ezbus_packet_set_type       ( tx_packet, packet_type_boot2_ak );
+    ezbus_packet_set_dst_socket ( tx_packet, EZBUS_SOCKET_ANY  );
+    ezbus_packet_set_src_socket ( tx_packet, EZBUS_SOCKET_ANY  );
+    ezbus_packet_set_seq        ( tx_packet, ezbus_packet_seq( packet ) );
+    ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    ezbus_packet_set_dst        ( tx_packet, ezbus_packet_src( packet ) );
 
-    ezbus_mac_transmitter_put( mac, &tx_packet );
+    ezbus_mac_transmitter_put( mac, tx_packet );
 }
 
 /*****************************************************************************
@@ -967,12 +957,98 @@ extern bool ezbus_mac_arbiter_online( ezbus_mac_t* mac )
     return (mac_arbiter_state == mac_arbiter_state_online);
 }
 
+/**
+ * @brief The arbiter has nothing to do until a frame arrives or a timer expires. That is, it is 
+ *          waiting out a boot cycle, paused, or online without the token.
+ */
+extern bool ezbus_mac_arbiter_idle( ezbus_mac_t* mac )
+{
+    switch( ezbus_mac_arbiter_get_state( mac ) )
+    {
+        case mac_arbiter_state_boot0_active:
+        case mac_arbiter_state_boot1_cycle_active:
+        case mac_arbiter_state_boot2_cycle_active:
+        case mac_arbiter_state_offline:
+        case mac_arbiter_state_pause:
+            return true;
+        case mac_arbiter_state_online:
+            return !ezbus_mac_token_acquired( mac );
+        default:
+            return false;
+    }
+}
+
 extern uint16_t ezbus_mac_arbiter_get_token_age( ezbus_mac_t* mac )
 {
     ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
     return arbiter->token_age;
 }
 
+extern void ezbus_mac_arbiter_set_token_weight( ezbus_mac_t* mac, uint8_t weight )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    arbiter->token_weight = weight ? weight : 1;
+}
+
+extern uint8_t ezbus_mac_arbiter_get_token_weight( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    return arbiter->token_weight;
+}
+
+extern uint32_t ezbus_mac_arbiter_get_token_budget( ezbus_mac_t* mac )
+{
+    return (uint32_t)ezbus_mac_arbiter_get_token_weight( mac ) * EZBUS_TOKEN_HOLD_BYTES;
+}
+
+extern void ezbus_mac_arbiter_token_spend( ezbus_mac_t* mac, uint32_t bytes )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    arbiter->token_sent += bytes;
+}
+
+extern uint8_t ezbus_mac_arbiter_get_token_hops( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    return arbiter->token_hops;
+}
+
+extern uint8_t ezbus_mac_arbiter_get_token_sweep( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    return arbiter->token_sweep;
+}
+
+extern bool ezbus_mac_arbiter_get_token_demand( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    return arbiter->token_demand || ezbus_mac_arbiter_ack_pending( mac ) || 
+           ezbus_socket_callback_transmitter_busy( mac ) || ezbus_socket_callback_urgent_open( mac );
+}
+
+extern bool ezbus_mac_arbiter_get_token_urgent( ezbus_mac_t* mac )
+{
+    return ezbus_socket_callback_transmitter_urgent( mac );
+}
+
+extern ezbus_address_t* ezbus_mac_arbiter_get_token_resume( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    return arbiter->token_resume ? &arbiter->token_resume_address : NULL;
+}
+
+/**
+ * @brief A fresh hold of the token, nothing sent against the budget yet.
+ */
+static void ezbus_mac_arbiter_token_hold_start( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    arbiter->token_sent = 0;
+    arbiter->token_idle = false;
+    arbiter->token_demand = false;
+    arbiter->token_resume = false;
+}
+
 static void ezbus_mac_arbiter_set_token_age( ezbus_mac_t* mac, uint16_t age )
 {
     ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
@@ -1009,6 +1085,34 @@ static void do_mac_arbiter_state_pause( ezbus_mac_t* mac )
    /* @note do nothing */
 }
 
+static bool ezbus_mac_arbiter_transmit_parcels( ezbus_mac_t* mac )
+{
+    /* 
+     * queue as many parcels as will fit, the transmitter sends them back-to-back, 
+     * until those sent and queued on this hold spend the budget. The last may overrun it.
+     * An early visit, or a peer waiting with urgent parcels, cuts the hold to the real-time sockets.
+     */
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    bool urgent_only = arbiter->token_resume || ezbus_mac_peers_next_urgent( mac ) != NULL;
+    bool sent = false;
+    while ( !ezbus_mac_arbiter_token_spent(mac) && 
+            ezbus_mac_arbiter_transmitter_ready(mac) && ezbus_socket_callback_transmitter_empty(mac,urgent_only) )
+    {
+        sent = true;
+    }
+    if ( sent || urgent_only )
+    {
+        /* bulk parcels held back for an urgent peer want the token back too */
+        arbiter->token_demand = true;
+    }
+    if ( !sent && ezbus_mac_transmitter_empty(mac) )
+    {
+        /* every socket was offered an idle transmitter and declined */
+        arbiter->token_idle = true;
+    }
+    return sent;
+}
+
 static void do_mac_arbiter_state_online( ezbus_mac_t* mac )
 {
     ezbus_socket_callback_run( mac );
@@ -1016,10 +1120,10 @@ static void do_mac_arbiter_state_online( ezbus_mac_t* mac )
     {
         ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
 
-        if ( ezbus_mac_arbiter_ready_to_ack(mac) )              ezbus_mac_arbiter_send_ack_parcel(mac)
-        else if ( ezbus_mac_arbiter_ready_to_nack(mac) )        ezbus_mac_arbiter_send_nack_parcel(mac)
-        else if ( ezbus_mac_arbiter_ready_to_give_token(mac) )  ezbus_mac_arbiter_give_token(mac)
-        else if ( ezbus_mac_arbiter_transmitter_ready(mac) && !ezbus_socket_callback_transmitter_empty(mac) )
+        ezbus_mac_arbiter_send_acks( mac );
+
+        if ( ezbus_mac_arbiter_ready_to_give_token(mac) )       ezbus_mac_arbiter_give_token(mac)
+        else if ( ezbus_mac_arbiter_transmitter_ready(mac) && !ezbus_mac_arbiter_transmit_parcels(mac) )
         {
             if ( (ezbus_mac_arbiter_get_token_period( mac ) ))
             {
@@ -1044,7 +1148,9 @@ static bool ezbus_mac_arbiter_receive_token( ezbus_mac_t* mac, ezbus_packet_t* p
     ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
     ezbus_crc_t crc;
 
-    arbiter->token_hold=0;
+    ezbus_mac_arbiter_token_hold_start( mac );
+    arbiter->token_hops=ezbus_packet_get_token_hops( packet );
+    arbiter->token_sweep=ezbus_packet_get_token_sweep( packet );
     ezbus_mac_peers_crc( mac, &crc );
     if ( ezbus_crc_equal( &crc, ezbus_packet_get_token_crc( packet ) ) )
     {
@@ -1072,38 +1178,47 @@ static bool ezbus_mac_arbiter_receive_token( ezbus_mac_t* mac, ezbus_packet_t* p
 ******************************************************************************
 *****************************************************************************/
 
-static void ezbus_mac_arbiter_ack_parcel( ezbus_mac_t* mac, uint8_t seq, ezbus_address_t* address )
+static bool ezbus_mac_arbiter_ack_parcel( ezbus_mac_t* mac, ezbus_mac_arbiter_ack_t* ack )
 {
-    ezbus_packet_t tx_packet;
-    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
-    ezbus_packet_t* rx_packet  = ezbus_mac_get_receiver_packet( mac );
+    ezbus_packet_control_t tx_control;
+    ezbus_packet_t* tx_packet = ezbus_packet_control( &tx_control );
 
-    ezbus_packet_init           ( &tx_packet );
-    ezbus_packet_set_type       ( &tx_packet, packet_type_ack );
-    ezbus_packet_set_dst_socket ( &tx_packet, arbiter->rx_ack_src_socket );
-    ezbus_packet_set_src_socket ( &tx_packet, arbiter->rx_ack_dst_socket );
-    ezbus_packet_set_seq        ( &tx_packet, ezbus_packet_seq( rx_packet ) );
-    ezbus_packet_set_src        ( &tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
-    ezbus_packet_set_dst        ( &tx_packet, ezbus_packet_src( rx_packet ) );
+    ezbus_packet_init           ( tx_packet );
+    ezbus_packet_set_type       ( tx_packet, ack->nack ? packet_type_nack : packet_type_ack );
+    ezbus_packet_set_dst_socket ( tx_packet, ack->src_socket );
+    ezbus_packet_set_src_socket ( tx_packet, ack->dst_socket );
+    ezbus_packet_set_seq        ( tx_packet, ack->seq );
+    ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    ezbus_packet_set_dst        ( tx_packet, &ack->address );
 
-    ezbus_mac_transmitter_put( mac, &tx_packet );
+    return ezbus_mac_transmitter_put( mac, tx_packet );
 }
 
-static void ezbus_mac_arbiter_nack_parcel( ezbus_mac_t* mac, uint8_t seq, ezbus_address_t* address )
+static void ezbus_mac_arbiter_send_acks( ezbus_mac_t* mac )
 {
-    ezbus_packet_t tx_packet;
+    /* every peer socket owed an answer gets one, as far as the transmitter has room */
     ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
-    ezbus_packet_t* rx_packet  = ezbus_mac_get_receiver_packet( mac );
-
-    ezbus_packet_init           ( &tx_packet );
-    ezbus_packet_set_type       ( &tx_packet, packet_type_nack );
-    ezbus_packet_set_dst_socket ( &tx_packet, arbiter->rx_nack_src_socket );
-    ezbus_packet_set_src_socket ( &tx_packet, arbiter->rx_nack_dst_socket );
-    ezbus_packet_set_seq        ( &tx_packet, ezbus_packet_seq( rx_packet ) );
-    ezbus_packet_set_src        ( &tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
-    ezbus_packet_set_dst        ( &tx_packet, ezbus_packet_src( rx_packet ) );
+    for( int index=0; index < EZBUS_MAX_SOCKETS && ezbus_mac_arbiter_transmitter_ready(mac); index++ )
+    {
+        ezbus_mac_arbiter_ack_t* ack = &arbiter->rx_ack[ index ];
+        if ( ack->pend && ezbus_mac_arbiter_ack_parcel( mac, ack ) )
+        {
+            ack->pend = false;
+        }
+    }
+}
 
-    ezbus_mac_transmitter_put( mac, &tx_packet );
+static bool ezbus_mac_arbiter_ack_pending( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    for( int index=0; index < EZBUS_MAX_SOCKETS; index++ )
+    {
+        if ( arbiter->rx_ack[ index ].pend )
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 
@@ -1134,7 +1249,26 @@ static void do_mac_packet_type_reset( ezbus_mac_t* mac, ezbus_packet_t* packet )
 
 static void do_mac_packet_type_take_token( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
-    if ( !ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), ezbus_packet_dst( packet ) ) )
+    ezbus_mac_arbiter_set_token_age( mac, ezbus_packet_get_token_age( packet ) );
+    ezbus_mac_peers_set_demand( mac, ezbus_packet_src( packet ), ezbus_packet_demand( packet ) != 0, ezbus_packet_urgent( packet ) != 0 );
+
+    ezbus_mac_token_reset( mac );
+
+    if ( ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), ezbus_packet_dst( packet ) ) )
+    {
+        /* an early visit, the ring carries on from the holder's place once the urgent parcels are out */
+        if ( ezbus_mac_arbiter_receive_token( mac, packet ) )
+        {
+            ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+            arbiter->token_resume = true;
+            ezbus_address_copy( &arbiter->token_resume_address, ezbus_packet_src( packet ) );
+            if ( !ezbus_mac_arbiter_online( mac ) )
+            {
+                ezbus_mac_arbiter_set_state( mac, mac_arbiter_state_service_start );
+            }
+        }
+    }
+    else
     {
         ezbus_mac_token_relinquish( mac );
     }
@@ -1143,6 +1277,7 @@ static void do_mac_packet_type_take_token( ezbus_mac_t* mac, ezbus_packet_t* pac
 static void do_mac_packet_type_give_token( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
     ezbus_mac_arbiter_set_token_age( mac, ezbus_packet_get_token_age( packet ) );
+    ezbus_mac_peers_set_demand( mac, ezbus_packet_src( packet ), ezbus_packet_demand( packet ) != 0, ezbus_packet_urgent( packet ) != 0 );
 
     ezbus_mac_token_reset( mac );
     
@@ -1159,35 +1294,63 @@ static void do_mac_packet_type_give_token( ezbus_mac_t* mac, ezbus_packet_t* pac
     }
 }
 
+static ezbus_mac_arbiter_ack_t* ezbus_mac_arbiter_ack_slot( ezbus_mac_t* mac, ezbus_packet_t* rx_packet )
+{
+    /* 
+     * The answer owed to the peer socket of the parcel, or a free one. Acks are cumulative, 
+     * so a pending ack simply advances to cover the parcel.
+     */
+    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
+    ezbus_mac_arbiter_ack_t* free_ack = NULL;
+    for( int index=0; index < EZBUS_MAX_SOCKETS; index++ )
+    {
+        ezbus_mac_arbiter_ack_t* ack = &arbiter->rx_ack[ index ];
+        if ( !ack->pend )
+        {
+            if ( free_ack == NULL )
+            {
+                free_ack = ack;
+            }
+        }
+        else if ( ack->src_socket == ezbus_packet_src_socket( rx_packet ) &&
+                  ezbus_address_compare( ezbus_packet_src( rx_packet ), &ack->address ) == 0 )
+        {
+            return ack;
+        }
+    }
+    return free_ack;
+}
+
 static void do_mac_packet_type_parcel( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
+    if ( ezbus_packet_ack_req( packet ) )
+    {
+        /* the recipient owes an ack, the token should call there soon, early if the parcel was urgent */
+        ezbus_peer_t* peer = ezbus_mac_peers_lookup( mac, ezbus_packet_dst( packet ) );
+        ezbus_peer_set_demand( peer, true );
+        if ( ezbus_packet_urgent( packet ) )
+        {
+            ezbus_peer_set_urgent( peer, true );
+        }
+    }
     if ( ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), ezbus_packet_dst( packet ) ) )
     {
         if ( ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), ezbus_packet_dst( packet ) ) )
         {
-            ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
             ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet( mac );
+            ezbus_mac_arbiter_ack_t* ack = ezbus_mac_arbiter_ack_slot( mac, rx_packet );
 
             EZBUS_LOG( EZBUS_LOG_RECEIVER, "" );
         
-            if ( !arbiter->rx_ack_pend && !arbiter->rx_nack_pend )
+            /* a pending nack stands, the peer resends from there, what follows it is of no use until then */
+            if ( ack != NULL && !( ack->pend && ack->nack ) )
             {
-                if ( ezbus_socket_callback_receiver_ready( mac, packet ) )
-                {
-                    arbiter->rx_ack_pend = (ezbus_packet_src_socket( rx_packet ) == EZBUS_SOCKET_INVALID) ? false : true;
-                    arbiter->rx_ack_seq = ezbus_packet_seq( rx_packet );
-                    arbiter->rx_ack_dst_socket = ezbus_packet_dst_socket( rx_packet );
-                    arbiter->rx_ack_src_socket = ezbus_packet_src_socket( rx_packet );
-                    ezbus_address_copy( &arbiter->rx_ack_address, ezbus_packet_src( rx_packet ) );
-                }
-                else
-                {
-                    arbiter->rx_nack_pend = (ezbus_packet_src_socket( rx_packet ) == EZBUS_SOCKET_INVALID) ? false : true;
-                    arbiter->rx_nack_seq = ezbus_packet_seq( rx_packet );         
-                    arbiter->rx_nack_dst_socket = ezbus_packet_dst_socket( rx_packet );
-                    arbiter->rx_nack_src_socket = ezbus_packet_src_socket( rx_packet );
-                    ezbus_address_copy( &arbiter->rx_nack_address, ezbus_packet_src( rx_packet ) );
-                }
+                ack->nack = !ezbus_socket_callback_receiver_ready( mac, packet );
+                ack->pend = (ezbus_packet_src_socket( rx_packet ) == EZBUS_SOCKET_INVALID) ? false : true;
+                ack->seq = ezbus_packet_seq( rx_packet );
+                ack->dst_socket = ezbus_packet_dst_socket( rx_packet );
+                ack->src_socket = ezbus_packet_src_socket( rx_packet );
+                ezbus_address_copy( &ack->address, ezbus_packet_src( rx_packet ) );
             }
         }
     }
@@ -1222,24 +1385,15 @@ static void do_mac_packet_type_ack( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
     if ( ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), ezbus_packet_dst( packet ) ) )
     {
-        ezbus_packet_t* tx_packet = ezbus_mac_get_transmitter_packet( mac );
-        if ( ezbus_address_compare( ezbus_packet_src(packet), ezbus_packet_dst(tx_packet) ) == 0 )
+        if ( ezbus_socket_callback_transmitter_ack( mac ) )
         {
-            if ( ezbus_packet_seq(packet) == ezbus_packet_seq(tx_packet) )
-            {
-                ezbus_mac_arbiter_transmit_reset( mac );
-                ezbus_socket_callback_transmitter_ack( mac );
-            }
-            else
-            {
-                ezbus_socket_callback_transmitter_fault( mac );
-                EZBUS_LOG( EZBUS_LOG_ARBITER, "recv: ack seq mismatch");
-            }
+            ezbus_mac_arbiter_transmit_acked( mac, packet );
+            ezbus_mac_arbiter_transmit_progress( mac );
         }
         else
         {
             ezbus_socket_callback_transmitter_fault( mac );
-            EZBUS_LOG( EZBUS_LOG_ARBITER, "recv: ack address mismatch" );
+            EZBUS_LOG( EZBUS_LOG_ARBITER, "recv: ack outside window" );
         }
     }
 }
@@ -1248,24 +1402,15 @@ static void do_mac_packet_type_nack( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
     if ( ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), ezbus_packet_dst( packet ) ) )
     {
-        ezbus_packet_t* tx_packet = ezbus_mac_get_transmitter_packet( mac );
-        if ( ezbus_address_compare( ezbus_packet_src(packet), ezbus_packet_dst(tx_packet) ) == 0 )
+        if ( ezbus_socket_callback_transmitter_nack( mac ) )
         {
-            if ( ezbus_packet_seq(packet) == ezbus_packet_seq(tx_packet) )
-            {
-                ezbus_mac_arbiter_transmit_reset( mac );
-                ezbus_socket_callback_transmitter_nack( mac );
-            }
-            else
-            {
-                ezbus_socket_callback_transmitter_fault( mac );
-                EZBUS_LOG( EZBUS_LOG_ARBITER, "recv: nack seq mismatch");
-            }
+            ezbus_mac_arbiter_transmit_acked( mac, packet );
+            ezbus_mac_arbiter_transmit_progress( mac );
         }
         else
         {
             ezbus_socket_callback_transmitter_fault( mac );
-            EZBUS_LOG( EZBUS_LOG_ARBITER, "recv: nack address mismatch" );
+            EZBUS_LOG( EZBUS_LOG_ARBITER, "recv: nack outside window" );
         }
     }
 }
@@ -1284,6 +1429,15 @@ extern void ezbus_mac_receiver_signal_full( ezbus_mac_t* mac )
          (arbiter->receiver_filter != NULL && 
             arbiter->receiver_filter(mac,packet) ) )
     {
+        if ( ezbus_mac_arbiter_online( mac ) && 
+             ( ezbus_packet_type( packet ) == packet_type_parcel || 
+               ezbus_packet_type( packet ) == packet_type_ack    || 
+               ezbus_packet_type( packet ) == packet_type_nack ) )
+        {
+            /* the token holder is still talking, a long burst is not a lost ring */
+            ezbus_mac_token_reset( mac );
+        }
+
         switch( ezbus_packet_type( packet ) )
         {
             case packet_type_reset:       do_mac_packet_type_reset       ( mac, packet ); break;
@@ -100,6 +100,16 @@ typedef struct _ezbus_mac_boot2_t
     uint8_t                     cycles;
 } ezbus_mac_boot2_state_t;
 
+typedef struct _ezbus_mac_arbiter_ack_t
+{
+    bool                        pend;
+    bool                        nack;           /* refused or out of order, the peer goes back to seq */
+    uint8_t                     seq;            /* cumulative, the last in-order parcel, or the one to resume from */
+    ezbus_address_t             address;
+    ezbus_socket_t              dst_socket;
+    ezbus_socket_t              src_socket;
+} ezbus_mac_arbiter_ack_t;
+
 typedef struct _ezbus_mac_arbiter_t
 {
     ezbus_mac_boot0_state_t     boot0_state;
@@ -114,19 +124,16 @@ typedef struct _ezbus_mac_arbiter_t
 
     uint16_t                    token_period;
     uint16_t                    token_age;          
-    uint16_t                    token_hold;
-
-    bool                        rx_ack_pend;
-    uint8_t                     rx_ack_seq;
-    ezbus_address_t             rx_ack_address;
-    ezbus_socket_t              rx_ack_dst_socket;
-    ezbus_socket_t              rx_ack_src_socket;
+    uint32_t                    token_sent;         /* bytes sent on this hold of the token */
+    uint8_t                     token_weight;       /* shares of EZBUS_TOKEN_HOLD_BYTES per hold */
+    bool                        token_idle;         /* the sockets had nothing to send on this hold */
+    uint8_t                     token_hops;         /* demand hops the token has made since the last full circle */
+    uint8_t                     token_sweep;        /* hops left in the full circle under way */
+    bool                        token_demand;       /* parcels were sent while holding the token */
+    bool                        token_resume;       /* this hold is an early visit, taken out of turn */
+    ezbus_address_t             token_resume_address;/* the holder which gave the early visit */
 
-    bool                        rx_nack_pend;
-    uint8_t                     rx_nack_seq;
-    ezbus_address_t             rx_nack_address;
-    ezbus_socket_t              rx_nack_dst_socket;
-    ezbus_socket_t              rx_nack_src_socket;
+    ezbus_mac_arbiter_ack_t     rx_ack[ EZBUS_MAX_SOCKETS ];   /* one ack or nack owed per peer socket */
 
     ezbus_mac_arbiter_token_period_callback_t   token_period_callback;
     ezbus_mac_arbiter_pause_callback_t          pause_callback;
@@ -137,9 +144,34 @@ typedef struct _ezbus_mac_arbiter_t
 extern void                         ezbus_mac_arbiter_init                      ( ezbus_mac_t* mac );
 extern void                         ezbus_mac_arbiter_run                       ( ezbus_mac_t* mac );
 extern bool                         ezbus_mac_arbiter_online                    ( ezbus_mac_t* mac );
+extern bool                         ezbus_mac_arbiter_idle                      ( ezbus_mac_t* mac );
 extern void                         ezbus_mac_arbiter_bootstrap                 ( ezbus_mac_t* mac );
 extern void                         ezbus_mac_arbiter_warm_bootstrap            ( ezbus_mac_t* mac );
 extern uint16_t                     ezbus_mac_arbiter_get_token_age             ( ezbus_mac_t* mac );
+/**
+ * @brief Set this node's share of each rotation, the token is held for weight * EZBUS_TOKEN_HOLD_BYTES
+ *        bytes on the wire, so a data concentrator may be given more of the bus than a sensor.
+ *        The weight is kept across a re-initialization of the arbiter.
+ */
+extern void                         ezbus_mac_arbiter_set_token_weight          ( ezbus_mac_t* mac, uint8_t weight );
+extern uint8_t                      ezbus_mac_arbiter_get_token_weight          ( ezbus_mac_t* mac );
+extern uint32_t                     ezbus_mac_arbiter_get_token_budget          ( ezbus_mac_t* mac );
+extern void                         ezbus_mac_arbiter_token_spend               ( ezbus_mac_t* mac, uint32_t bytes );
+extern uint8_t                      ezbus_mac_arbiter_get_token_hops            ( ezbus_mac_t* mac );
+extern uint8_t                      ezbus_mac_arbiter_get_token_sweep           ( ezbus_mac_t* mac );
+/**
+ * @brief This node wants the token back, it sent parcels on the last hold, has parcels awaiting acknowledgement, 
+ *        owes an acknowledgement, or keeps a real-time socket open.
+ */
+extern bool                         ezbus_mac_arbiter_get_token_demand          ( ezbus_mac_t* mac );
+/**
+ * @brief This node has parcels of a real-time socket waiting, and asks the holder for an early visit.
+ */
+extern bool                         ezbus_mac_arbiter_get_token_urgent          ( ezbus_mac_t* mac );
+/**
+ * @brief The holder whose place in the ring this early visit resumes from, NULL on a hold taken in turn.
+ */
+extern ezbus_address_t*             ezbus_mac_arbiter_get_token_resume          ( ezbus_mac_t* mac );
 extern void                         ezbus_mac_arbiter_set_token_period_callback ( ezbus_mac_t* mac, ezbus_mac_arbiter_token_period_callback_t callback );
 extern void                         ezbus_mac_arbiter_set_token_period          ( ezbus_mac_t* mac, uint16_t token_age_trigger );
 extern uint16_t                     ezbus_mac_arbiter_get_token_period          ( ezbus_mac_t* mac );
@@ -166,12 +166,10 @@ extern void ezbus_mac_arbiter_pause_stop ( ezbus_mac_t* mac )
 
 static void ezbus_mac_arbiter_pause_set_packet( ezbus_mac_t* mac, ezbus_packet_t* packet, const ezbus_address_t* address )
 {
-    ezbus_mac_arbiter_t* arbiter = ezbus_mac_get_arbiter( mac );
-    
     ezbus_packet_init           ( packet );
     ezbus_packet_set_type       ( packet, packet_type_pause );
-    ezbus_packet_set_dst_socket ( packet, arbiter->rx_ack_src_socket );
-    ezbus_packet_set_src_socket ( packet, arbiter->rx_ack_dst_socket );
+    ezbus_packet_set_dst_socket ( packet, EZBUS_SOCKET_ANY );
+    ezbus_packet_set_src_socket ( packet, EZBUS_SOCKET_ANY );
     ezbus_packet_set_src        ( packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
     ezbus_packet_set_dst        ( packet, address );
 }
@@ -179,12 +177,13 @@ static void ezbus_mac_arbiter_pause_set_packet( ezbus_mac_t* mac, ezbus_packet_t
 
 static void ezbus_mac_arbiter_pause_broadcast_start( ezbus_mac_t* mac )
 {
-    ezbus_packet_t packet;
+    ezbus_packet_control_t control;
+    ezbus_packet_t* packet = ezbus_packet_control( &control );
 
-    ezbus_mac_arbiter_pause_set_packet( mac, &packet, &ezbus_broadcast_address );
-    ezbus_pause_set_active            ( ezbus_packet_get_pause( &packet ), true );
-    ezbus_pause_set_duration          ( ezbus_packet_get_pause( &packet ), ezbus_mac_arbiter_pause_get_duration( mac ) );
-    ezbus_mac_transmitter_put         ( mac, &packet );
+    ezbus_mac_arbiter_pause_set_packet( mac, packet, &ezbus_broadcast_address );
+    ezbus_pause_set_active            ( ezbus_packet_get_pause( packet ), true );
+    ezbus_pause_set_duration          ( ezbus_packet_get_pause( packet ), ezbus_mac_arbiter_pause_get_duration( mac ) );
+    ezbus_mac_transmitter_put         ( mac, packet );
 }
 
 extern void ezbus_mac_arbiter_pause_set_duration( ezbus_mac_t* mac, ezbus_ms_tick_t duration )
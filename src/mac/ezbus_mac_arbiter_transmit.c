@@ -30,6 +30,9 @@
 #include <ezbus_platform.h>
 
 static void ezbus_arbiter_ack_tx_timer_triggered ( ezbus_timer_t* timer, void* arg );
+static void ezbus_mac_arbiter_transmit_schedule   ( ezbus_mac_t* mac );
+static void ezbus_mac_arbiter_transmit_hold       ( ezbus_mac_t* mac, bool release );
+static void ezbus_mac_arbiter_transmit_karn       ( ezbus_mac_t* mac );
 
 extern void ezbus_mac_arbiter_transmit_init  ( ezbus_mac_t* mac )
 {
@@ -37,7 +40,7 @@ extern void ezbus_mac_arbiter_transmit_init  ( ezbus_mac_t* mac )
 
     ezbus_mac_timer_setup( mac, &arbiter_transmit->ack_tx_timer, true );
     ezbus_timer_set_key( &arbiter_transmit->ack_tx_timer, "ack_tx_timer" );
-    ezbus_timer_set_period( &arbiter_transmit->ack_tx_timer, ezbus_mac_token_ring_time(mac)*4 ); // FIXME *4 ??
+    ezbus_timer_set_period( &arbiter_transmit->ack_tx_timer, ezbus_mac_token_retransmit_time(mac) );
     ezbus_timer_set_callback( &arbiter_transmit->ack_tx_timer, ezbus_arbiter_ack_tx_timer_triggered, mac );
 }
 
@@ -59,6 +62,25 @@ extern void ezbus_mac_transmitter_signal_full( ezbus_mac_t* mac )
 
 extern void ezbus_mac_transmitter_signal_sent( ezbus_mac_t* mac )
 {
+    if ( ezbus_mac_token_acquired( mac ) )
+    {
+        /* a burst of frames may outlast the ring time, the holder is not lost */
+        ezbus_mac_token_reset( mac );
+        ezbus_mac_arbiter_token_spend( mac, ezbus_packet_tx_size( ezbus_mac_get_transmitter_packet( mac ) ) );
+        ezbus_mac_arbiter_transmit_hold( mac, false );
+    }
+    else if ( ezbus_mac_transmitter_get_packet_type( mac ) == packet_type_give_token ||
+              ezbus_mac_transmitter_get_packet_type( mac ) == packet_type_take_token )
+    {
+        ezbus_mac_arbiter_transmit_hold( mac, true );
+    }
+    if ( ezbus_mac_transmitter_get_packet_type( mac ) == packet_type_parcel && ezbus_packet_urgent( ezbus_mac_get_transmitter_packet( mac ) ) )
+    {
+        /* the sender does not hear its own parcel, it marks the recipient owing an urgent ack as the others do */
+        ezbus_peer_t* peer = ezbus_mac_peers_lookup( mac, ezbus_packet_dst( ezbus_mac_get_transmitter_packet( mac ) ) );
+        ezbus_peer_set_demand( peer, true );
+        ezbus_peer_set_urgent( peer, true );
+    }
     if ( ezbus_mac_transmitter_get_packet_type( mac ) != packet_type_give_token )
         EZBUS_LOG( EZBUS_LOG_TRANSMITTER, "%d", ezbus_mac_transmitter_get_packet_type( mac ) );
 }
@@ -72,11 +94,74 @@ extern void ezbus_mac_transmitter_signal_wait( ezbus_mac_t* mac )
 
     EZBUS_LOG( EZBUS_LOG_TRANSMITTER, "" );
 
-    arbiter_transmit->ack_tx_count = EZBUS_RETRANSMIT_TRIES;
-    ezbus_timer_restart( &arbiter_transmit->ack_tx_timer );
+    /* 
+     * The transmitter does not block waiting for the ack, each socket times its own 
+     * oldest un-acknowledged parcel while further parcels fill the window.
+     */
+    ezbus_packet_t* tx_packet = ezbus_mac_get_transmitter_packet( mac );
+    if ( !arbiter_transmit->ack_rtt_timing && 
+         ezbus_socket_callback_transmitter_first( mac, ezbus_packet_src_socket( tx_packet ), ezbus_packet_seq( tx_packet ) ) )
+    {
+        /* one parcel at a time is timed, from the end of its frame to its ack */
+        arbiter_transmit->ack_rtt_timing = true;
+        arbiter_transmit->ack_rtt_hold   = true;
+        arbiter_transmit->ack_rtt_start  = ezbus_platform.callback_get_ms_ticks();
+        arbiter_transmit->ack_rtt_socket = ezbus_packet_src_socket( tx_packet );
+        arbiter_transmit->ack_rtt_seq    = ezbus_packet_seq( tx_packet );
+        ezbus_address_copy( &arbiter_transmit->ack_rtt_address, ezbus_packet_dst( tx_packet ) );
+    }
+    ezbus_socket_callback_transmitter_wait( mac, ezbus_packet_src_socket( tx_packet ), ezbus_packet_seq( tx_packet ) );
+    ezbus_mac_arbiter_transmit_schedule( mac );
+}
+
+static void ezbus_mac_arbiter_transmit_hold( ezbus_mac_t* mac, bool release )
+{
+    /* no peer can ack before this node hands on the token, the waits run from the last frame of the hold */
+    ezbus_mac_arbiter_transmit_t* arbiter_transmit = ezbus_mac_get_arbiter_transmit( mac );
+    if ( arbiter_transmit->ack_tx_wait )
+    {
+        ezbus_socket_callback_transmitter_hold( mac, release );
+        ezbus_mac_arbiter_transmit_schedule( mac );
+        if ( arbiter_transmit->ack_rtt_timing && arbiter_transmit->ack_rtt_hold )
+        {
+            arbiter_transmit->ack_rtt_start = ezbus_platform.callback_get_ms_ticks();
+            arbiter_transmit->ack_rtt_hold  = !release;
+        }
+    }
+}
+
+extern void ezbus_mac_arbiter_transmit_acked( ezbus_mac_t* mac, ezbus_packet_t* packet )
+{
+    ezbus_mac_arbiter_transmit_t* arbiter_transmit = ezbus_mac_get_arbiter_transmit( mac );
+
+    if ( ezbus_packet_type( packet ) == packet_type_nack )
+    {
+        ezbus_mac_arbiter_transmit_karn( mac );
+    }
+    else if ( arbiter_transmit->ack_rtt_timing &&
+              ezbus_packet_dst_socket( packet ) == arbiter_transmit->ack_rtt_socket &&
+              ezbus_address_compare( ezbus_packet_src( packet ), &arbiter_transmit->ack_rtt_address ) == 0 &&
+              (uint8_t)( ezbus_packet_seq( packet ) - arbiter_transmit->ack_rtt_seq ) < 0x80 )
+    {
+        /* acks are cumulative, this one covers the timed parcel */
+        ezbus_ms_tick_t sample = ezbus_platform.callback_get_ms_ticks() - arbiter_transmit->ack_rtt_start;
+        ezbus_mac_peers_rtt_sample( mac, &arbiter_transmit->ack_rtt_address, sample );
+        arbiter_transmit->ack_rtt_timing = false;
+    }
 }
 
 
+static void ezbus_mac_arbiter_transmit_karn( ezbus_mac_t* mac )
+{
+    /* Karn, an ack of a parcel sent twice can not say which of the two it answers, only a rewind of the timed socket ends the timing */
+    ezbus_mac_arbiter_transmit_t* arbiter_transmit = ezbus_mac_get_arbiter_transmit( mac );
+    if ( arbiter_transmit->ack_rtt_timing &&
+         !ezbus_socket_callback_transmitter_first( mac, arbiter_transmit->ack_rtt_socket, arbiter_transmit->ack_rtt_seq ) )
+    {
+        arbiter_transmit->ack_rtt_timing = false;
+    }
+}
+
 static void ezbus_arbiter_ack_tx_timer_triggered( ezbus_timer_t* timer, void* arg )
 {
     ezbus_mac_t* mac = (ezbus_mac_t*)arg;
@@ -84,67 +169,171 @@ static void ezbus_arbiter_ack_tx_timer_triggered( ezbus_timer_t* timer, void* ar
 
     EZBUS_LOG( EZBUS_LOG_ARBITER, "" );
     
-    if ( arbiter_transmit->ack_tx_count-- > 0 )
+    ezbus_socket_callback_transmitter_expire( mac );
+    ezbus_mac_arbiter_transmit_karn( mac );
+    arbiter_transmit->ack_tx_wait = false;
+    ezbus_mac_arbiter_transmit_schedule( mac );
+}
+
+extern bool ezbus_mac_arbiter_transmit_busy ( ezbus_mac_t* mac )
+{
+    ezbus_mac_arbiter_transmit_t* arbiter_transmit = ezbus_mac_get_arbiter_transmit( mac );
+    return arbiter_transmit->ack_tx_wait;
+}
+
+extern void ezbus_mac_arbiter_transmit_progress( ezbus_mac_t* mac )
+{
+    /* the window of one socket moved, the others keep their deadlines */
+    if ( ezbus_socket_callback_transmitter_busy( mac ) )
     {
-        if ( ezbus_socket_callback_transmitter_resend( mac ) )
-        {
-            ezbus_timer_restart( &arbiter_transmit->ack_tx_timer );
-        }
-        else
-        {
-            ezbus_mac_arbiter_transmit_reset( mac );
-        }
+        ezbus_mac_arbiter_transmit_schedule( mac );
     }
     else
     {
         ezbus_mac_arbiter_transmit_reset( mac );
-        ezbus_socket_callback_transmitter_limit( mac );
     }
 }
 
-extern bool ezbus_mac_arbiter_transmit_busy ( ezbus_mac_t* mac )
+static void ezbus_mac_arbiter_transmit_schedule( ezbus_mac_t* mac )
 {
+    /* one timer serves every socket, it is set for the earliest of their deadlines */
     ezbus_mac_arbiter_transmit_t* arbiter_transmit = ezbus_mac_get_arbiter_transmit( mac );
-    return ( arbiter_transmit->ack_tx_count != 0 );
-}
+    ezbus_ms_tick_t deadline;
 
+    if ( ezbus_socket_callback_transmitter_deadline( mac, &deadline ) )
+    {
+        /* left alone while the deadline holds, a restart on every frame would put off an overdue expiry */
+        if ( !arbiter_transmit->ack_tx_wait || deadline != arbiter_transmit->ack_tx_deadline )
+        {
+            int32_t period = (int32_t)( deadline - ezbus_platform.callback_get_ms_ticks() );
+            arbiter_transmit->ack_tx_wait     = true;
+            arbiter_transmit->ack_tx_deadline = deadline;
+            ezbus_timer_set_period( &arbiter_transmit->ack_tx_timer, ( period > 0 ) ? period : 1 );
+            ezbus_timer_restart( &arbiter_transmit->ack_tx_timer );
+        }
+    }
+    else
+    {
+        arbiter_transmit->ack_tx_wait = false;
+        ezbus_timer_stop( &arbiter_transmit->ack_tx_timer );
+    }
+}
 
 extern void ezbus_mac_arbiter_transmit_reset( ezbus_mac_t* mac )
 {
     ezbus_mac_arbiter_transmit_t* arbiter_transmit = ezbus_mac_get_arbiter_transmit( mac );
     ezbus_timer_stop( &arbiter_transmit->ack_tx_timer );
-    arbiter_transmit->ack_tx_count = 0;
+    arbiter_transmit->ack_tx_wait = false;
+    arbiter_transmit->ack_rtt_timing = false;
 }
 
 /**** END TRANSMITTER ACKNOWLEDGE ****/
 
+extern void ezbus_mac_transmitter_signal_release( ezbus_mac_t* mac, ezbus_packet_t* packet )
+{
+    ezbus_socket_callback_transmitter_release( mac, packet );
+}
+
 extern void ezbus_mac_transmitter_signal_fault( ezbus_mac_t* mac )
 {
     EZBUS_LOG( EZBUS_LOG_TRANSMITTER, "%s",ezbus_fault_str( ezbus_mac_transmitter_get_err( mac ) ) );
     ezbus_mac_transmitter_reset( mac );
 }
 
+/**
+ * @brief Choose where the token goes next. Between full circles of the ring, the token goes straight 
+ *        to the next peer advertising demand, skipping the idle ones. After EZBUS_TOKEN_DEMAND_HOPS 
+ *        such hops, a full circle calls on every peer, so a quiet peer waits at most that many hops 
+ *        and one circle for the token.
+ *        A peer advertising urgent parcels is given an early visit out of turn, by a take_token. 
+ *        That visit counts as a demand hop, and the ring carries on from the place of the holder which gave it.
+ */
+static ezbus_address_t* ezbus_mac_arbiter_transmit_token_dst( ezbus_mac_t* mac, uint8_t* hops, uint8_t* sweep, bool* take )
+{
+    const ezbus_address_t* self_address = ezbus_port_get_address(ezbus_mac_get_port(mac));
+    const ezbus_address_t* from_address = ezbus_mac_arbiter_get_token_resume( mac );
+    ezbus_address_t* dst_address;
+
+    *hops  = ezbus_mac_arbiter_get_token_hops( mac );
+    *sweep = ezbus_mac_arbiter_get_token_sweep( mac );
+    *take  = false;
+
+    if ( from_address == NULL )
+    {
+        /* an early visit is not passed on to another, so the holder it came from is not starved */
+        ezbus_address_t* urgent_address = ezbus_mac_peers_next_urgent( mac );
+        if ( urgent_address != NULL )
+        {
+            if ( *sweep == 0 && EZBUS_TOKEN_DEMAND_HOPS > 0 )
+            {
+                ++(*hops);
+            }
+            *take = true;
+            return urgent_address;
+        }
+        from_address = self_address;
+    }
+
+    dst_address = ezbus_mac_peers_next( mac, from_address );
+    if ( ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), dst_address ) )
+    {
+        dst_address = ezbus_mac_peers_next( mac, self_address );
+    }
+
+    if ( *sweep == 0 && EZBUS_TOKEN_DEMAND_HOPS > 0 )
+    {
+        if ( *hops < EZBUS_TOKEN_DEMAND_HOPS )
+        {
+            ezbus_address_t* demand_address = ezbus_mac_peers_next_demand( mac, from_address );
+            if ( demand_address != NULL )
+            {
+                dst_address = demand_address;
+            }
+            ++(*hops);
+        }
+        else
+        {
+            *hops  = 0;
+            *sweep = ezbus_mac_peers_count( mac ) - 1;
+        }
+    }
+
+    if ( *sweep > 0 )
+    {
+        --(*sweep);
+    }
+
+    return dst_address;
+}
+
 extern void ezbus_mac_arbiter_transmit_token( ezbus_mac_t* mac )
 {
     ezbus_crc_t crc;
-    ezbus_packet_t tx_packet;
-    ezbus_address_t* dst_address = ezbus_mac_peers_next( mac, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    uint8_t hops;
+    uint8_t sweep;
+    bool take;
+    ezbus_packet_control_t tx_control;
+    ezbus_packet_t* tx_packet = ezbus_packet_control( &tx_control );
+    ezbus_address_t* dst_address = ezbus_mac_arbiter_transmit_token_dst( mac, &hops, &sweep, &take );
 
     EZBUS_LOG( EZBUS_LOG_TOKEN, "" );
 
-    ezbus_packet_init           ( &tx_packet );
-    ezbus_packet_set_type       ( &tx_packet, packet_type_give_token );
-    ezbus_packet_set_src_socket ( &tx_packet, EZBUS_SOCKET_ANY );
-    ezbus_packet_set_dst_socket ( &tx_packet, EZBUS_SOCKET_ANY );
-    ezbus_packet_set_seq        ( &tx_packet, 0 );                        /* FIXME seq? */
-    ezbus_packet_set_src        ( &tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
-    ezbus_packet_set_dst        ( &tx_packet, dst_address );
+    ezbus_packet_init           ( tx_packet );
+    ezbus_packet_set_type       ( tx_packet, take ? packet_type_take_token : packet_type_give_token );
+    ezbus_packet_set_src_socket ( tx_packet, EZBUS_SOCKET_ANY );
+    ezbus_packet_set_dst_socket ( tx_packet, EZBUS_SOCKET_ANY );
+    ezbus_packet_set_seq        ( tx_packet, 0 );                        /* FIXME seq? */
+    ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    ezbus_packet_set_dst        ( tx_packet, dst_address );
+    ezbus_packet_set_demand     ( tx_packet, ezbus_mac_arbiter_get_token_demand( mac ) ? PACKET_BITS_DEMAND : 0 );
+    ezbus_packet_set_urgent     ( tx_packet, ezbus_mac_arbiter_get_token_urgent( mac ) ? PACKET_BITS_URGENT : 0 );
 
     ezbus_mac_peers_crc( mac, &crc );
 
-    ezbus_packet_set_token_crc( &tx_packet, &crc );
-    ezbus_packet_set_token_age( &tx_packet, ezbus_mac_arbiter_get_token_age( mac )+1 );
+    ezbus_packet_set_token_crc  ( tx_packet, &crc );
+    ezbus_packet_set_token_age  ( tx_packet, ezbus_mac_arbiter_get_token_age( mac )+1 );
+    ezbus_packet_set_token_hops ( tx_packet, hops );
+    ezbus_packet_set_token_sweep( tx_packet, sweep );
 
-    ezbus_mac_transmitter_put( mac, &tx_packet );
+    ezbus_mac_transmitter_put( mac, tx_packet );
 }
-
@@ -29,8 +29,16 @@
 
 typedef struct _ezbus_mac_arbiter_transmit_t
 {
-    ezbus_timer_t                   ack_tx_timer;
-    uint8_t                         ack_tx_count;
+    ezbus_timer_t                   ack_tx_timer;       /* set for the earliest of the socket deadlines */
+    ezbus_ms_tick_t                 ack_tx_deadline;    /* the tick the timer is set for */
+    bool                            ack_tx_wait;        /* some socket is waiting on an ack */
+
+    bool                            ack_rtt_timing;     /* a parcel is being timed to its ack */
+    bool                            ack_rtt_hold;       /* it went out in the current token hold, the timing runs from its end */
+    ezbus_ms_tick_t                 ack_rtt_start;
+    ezbus_address_t                 ack_rtt_address;
+    ezbus_socket_t                  ack_rtt_socket;
+    uint8_t                         ack_rtt_seq;
 } ezbus_mac_arbiter_transmit_t;
 
 
@@ -46,6 +54,12 @@ extern void ezbus_mac_arbiter_transmit_pop  ( ezbus_mac_t* mac, uint8_t level );
 
 extern bool ezbus_mac_arbiter_transmit_busy ( ezbus_mac_t* mac ); /* state machine? */
 extern void ezbus_mac_arbiter_transmit_reset( ezbus_mac_t* mac ); /* state machine? */
+/**
+ * @brief An ack or nack for this node was accepted, take a round trip sample from an ack of the 
+ *        timed parcel, a nack means parcels go out again and their acks are ambiguous.
+ */
+extern void ezbus_mac_arbiter_transmit_acked( ezbus_mac_t* mac, ezbus_packet_t* packet );
+extern void ezbus_mac_arbiter_transmit_progress( ezbus_mac_t* mac );
 
 #ifdef __cplusplus
 }
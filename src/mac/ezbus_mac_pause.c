@@ -93,6 +93,41 @@ extern bool ezbus_mac_pause_active( ezbus_mac_t* mac )
             pause->state != ezbus_pause_state_run);
 }
 
+/**
+ * @brief The number of milli-seconds until the pause state machine next has work to do.
+ * @return 0 when a state transition is pending, EZBUS_TIMER_FOREVER when stopped.
+ */
+extern ezbus_ms_tick_t ezbus_mac_pause_next_expiry( ezbus_mac_t* mac )
+{
+    ezbus_mac_pause_t* pause = ezbus_mac_get_pause( mac );
+    ezbus_ms_tick_t    start;
+    ezbus_ms_tick_t    period;
+    ezbus_ms_tick_t    elapsed;
+
+    switch( pause->state )
+    {
+        case ezbus_pause_state_stopped:
+            return EZBUS_TIMER_FOREVER;
+        case ezbus_pause_state_run:
+            start  = pause->period_timer_start;
+            period = pause->period;
+            break;
+        case ezbus_pause_state_wait1:
+            start  = pause->duration_timer_start;
+            period = pause->duration/2;
+            break;
+        case ezbus_pause_state_wait2:
+            start  = pause->duration_timer_start;
+            period = pause->duration;
+            break;
+        default:
+            /* transitions wait on the callback, without one the state machine stays put */
+            return pause->callback ? 0 : EZBUS_TIMER_FOREVER;
+    }
+    elapsed = ezbus_platform.callback_get_ms_ticks() - start;
+    return ( elapsed > period ) ? 0 : ( period - elapsed ) + 1;
+}
+
 extern void ezbus_mac_pause_stop( ezbus_mac_t* mac )
 {
     ezbus_mac_pause_set_state( mac, ezbus_pause_state_stopping );
@@ -65,6 +65,7 @@ extern void                     ezbus_mac_pause_setup       (
 extern void                     ezbus_mac_pause_run         ( ezbus_mac_t* mac );
 extern void                     ezbus_mac_pause_start       ( ezbus_mac_t* mac );
 extern bool                     ezbus_mac_pause_active      ( ezbus_mac_t* mac );
+extern ezbus_ms_tick_t          ezbus_mac_pause_next_expiry ( ezbus_mac_t* mac );
 extern bool                     ezbus_mac_pause_one_shot    ( ezbus_mac_t* mac );
 extern void                     ezbus_mac_pause_stop        ( ezbus_mac_t* mac );
 extern void                     ezbus_mac_pause_set_duration( ezbus_mac_t* mac, ezbus_ms_tick_t duration );
@@ -21,6 +21,7 @@
 *****************************************************************************/
 #include <ezbus_address.h>
 #include <ezbus_mac_peers.h>
+#include <ezbus_mac_token.h>
 #include <ezbus_hex.h>
 #include <ezbus_crc.h>
 #include <ezbus_log.h>
@@ -30,11 +31,14 @@
 static void         ezbus_mac_peers_insort_self( ezbus_mac_t* mac );
 static EZBUS_ERR    ezbus_mac_peers_append  ( ezbus_mac_t* mac, const ezbus_peer_t* peer );
 static EZBUS_ERR    ezbus_mac_peers_insert  ( ezbus_mac_t* mac, const ezbus_peer_t* peer, int index );
+static int          ezbus_mac_peers_search  ( ezbus_mac_t* mac, const ezbus_address_t* address, bool* found );
+static void         ezbus_mac_peers_refresh ( ezbus_mac_t* mac );
 
 extern void ezbus_mac_peers_init(ezbus_mac_t* mac)
 {
     ezbus_mac_peers_t* peers = ezbus_mac_get_peers(mac);
     ezbus_platform.callback_memset(peers,0,sizeof(ezbus_mac_peers_t));
+    ezbus_mac_peers_refresh( mac );
     ezbus_mac_peers_insort_self( mac );
 }
 
@@ -82,20 +86,12 @@ extern EZBUS_ERR ezbus_mac_peers_insort( ezbus_mac_t* mac, const ezbus_peer_t* p
     {
         if ( !ezbus_address_is_broadcast( ezbus_peer_get_address( peer ) ) )
         {
-            if ( ezbus_mac_peers_index_of( mac, ezbus_peer_get_address( peer ) ) < 0 )
+            /* one search finds both a duplicate and the insert point */
+            bool found;
+            int index = ezbus_mac_peers_search( mac, ezbus_peer_get_address( peer ), &found );
+            if ( !found )
             {
-                for( int index=0; index < ezbus_mac_peers_count( mac ); index++ )
-                {
-                    ezbus_address_t* other_address = ezbus_peer_get_address( ezbus_mac_peers_at( mac, index ) );
-                    ezbus_address_t* peer_address = ezbus_peer_get_address( peer );
-
-                    if ( ezbus_address_compare( peer_address, other_address ) < 0 )
-                    {
-                        err = ezbus_mac_peers_insert( mac, peer, index );
-                        return err;
-                    }
-                }
-                err = ezbus_mac_peers_append( mac, peer );
+                err = ezbus_mac_peers_insert( mac, peer, index );
             }
             else
             {
@@ -147,15 +143,63 @@ extern int  ezbus_mac_peers_full( ezbus_mac_t* mac )
 
 extern int ezbus_mac_peers_index_of( ezbus_mac_t* mac, const ezbus_address_t* address )
 {
-    for(int index=0; index < ezbus_mac_peers_count( mac ); index++)
+    bool found;
+    int index = ezbus_mac_peers_search( mac, address, &found );
+    return found ? index : -1;
+}
+
+/**
+ * @brief Binary search of the sorted list.
+ * @return The index of the address, or where it would be inserted when not found.
+ */
+static int ezbus_mac_peers_search( ezbus_mac_t* mac, const ezbus_address_t* address, bool* found )
+{
+    ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
+    int low  = 0;
+    int high = ezbus_mac_peers_count( mac );
+
+    *found = false;
+    while ( low < high )
     {
-        if ( ezbus_address_compare( ezbus_peer_get_address( ezbus_mac_peers_at(mac,index) ), address ) == 0 )
+        int mid = low + ( high - low ) / 2;
+        int compare = ezbus_address_compare( ezbus_peer_get_address( &peers->list[mid] ), address );
+        if ( compare == 0 )
+        {
+            *found = true;
+            return mid;
+        }
+        else if ( compare < 0 )
+        {
+            low = mid + 1;
+        }
+        else
         {
-            return index;
+            high = mid;
         }
     }
-    return -1;
+    return low;
+}
+
+/**
+ * @brief Locate this node, and the peer which follows it, and checksum the membership,
+ *        after the list has changed.
+ */
+static void ezbus_mac_peers_refresh( ezbus_mac_t* mac )
+{
+    ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
 
+    ezbus_crc_init( &peers->crc );
+    for(int index=0; index < ezbus_mac_peers_count(mac); index++)
+    {
+        ezbus_crc( &peers->crc, ezbus_peer_get_address( &peers->list[index] ), sizeof(ezbus_address_t) );
+    }
+
+    peers->self = ezbus_mac_peers_index_of( mac, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    if ( peers->self >= 0 )
+    {
+        int next = ( peers->self + 1 < ezbus_mac_peers_count( mac ) ) ? peers->self + 1 : 0;
+        ezbus_address_copy( &peers->successor, ezbus_peer_get_address( &peers->list[next] ) );
+    }
 }
 
 extern ezbus_peer_t* ezbus_mac_peers_lookup( ezbus_mac_t* mac, const ezbus_address_t* address )
@@ -170,21 +214,92 @@ extern ezbus_peer_t* ezbus_mac_peers_lookup( ezbus_mac_t* mac, const ezbus_addre
 
 extern ezbus_address_t* ezbus_mac_peers_next( ezbus_mac_t* mac, const ezbus_address_t* address )
 {
+    ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
+
+    if ( peers->self >= 0 && ezbus_port_get_address_is_self( ezbus_mac_get_port(mac), address ) )
+    {
+        /* token handoff, the common case */
+        return &peers->successor;
+    }
     if ( ezbus_mac_peers_count( mac ) > 0 )
     {
-        for( int index=ezbus_mac_peers_index_of( mac, address ); index >= 0 && index < ezbus_mac_peers_count( mac ); index++ )
+        bool found;
+        int index = ezbus_mac_peers_search( mac, address, &found );
+        if ( found && index+1 < ezbus_mac_peers_count( mac ) )
         {
-            ezbus_peer_t* other = ezbus_mac_peers_at(mac,index);
-            if ( ezbus_address_compare( address, &other->address ) < 0 )
-            {
-                return ezbus_peer_get_address( other );
-            }
+            return ezbus_peer_get_address( ezbus_mac_peers_at(mac,index+1) );
         }
         return ezbus_peer_get_address( ezbus_mac_peers_at(mac,0) );
     }
     return (ezbus_address_t*)address;
 }
 
+/**
+ * @brief Walk the ring from the peer following address, to the first peer other than this node
+ *        advertising demand, or urgent demand, for the token.
+ */
+static ezbus_address_t* ezbus_mac_peers_next_wanting( ezbus_mac_t* mac, const ezbus_address_t* address, bool urgent )
+{
+    ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
+    int count = ezbus_mac_peers_count( mac );
+
+    if ( count > 0 )
+    {
+        bool found;
+        int index = ezbus_mac_peers_search( mac, address, &found );
+        int first = found ? index + 1 : index;
+        for( int n=0; n < count; n++ )
+        {
+            int at = ( first + n ) % count;
+            ezbus_peer_t* peer = ezbus_mac_peers_at( mac, at );
+            if ( at != peers->self && ( urgent ? ezbus_peer_get_urgent( peer ) : ezbus_peer_get_demand( peer ) ) )
+            {
+                return ezbus_peer_get_address( peer );
+            }
+        }
+    }
+    return NULL;
+}
+
+extern ezbus_address_t* ezbus_mac_peers_next_demand( ezbus_mac_t* mac, const ezbus_address_t* address )
+{
+    return ezbus_mac_peers_next_wanting( mac, address, false );
+}
+
+extern ezbus_address_t* ezbus_mac_peers_next_urgent( ezbus_mac_t* mac )
+{
+    return ezbus_mac_peers_next_wanting( mac, ezbus_port_get_address(ezbus_mac_get_port(mac)), true );
+}
+
+extern void ezbus_mac_peers_set_demand( ezbus_mac_t* mac, const ezbus_address_t* address, bool demand, bool urgent )
+{
+    ezbus_peer_t* peer = ezbus_mac_peers_lookup( mac, address );
+    ezbus_peer_set_demand( peer, demand );
+    ezbus_peer_set_urgent( peer, urgent );
+}
+
+extern void ezbus_mac_peers_rtt_sample( ezbus_mac_t* mac, const ezbus_address_t* address, ezbus_ms_tick_t sample )
+{
+    ezbus_rtt_t* rtt = ezbus_peer_get_rtt( ezbus_mac_peers_lookup( mac, address ) );
+    if ( rtt != NULL )
+    {
+        ezbus_rtt_sample( rtt, sample );
+    }
+}
+
+extern uint32_t ezbus_mac_peers_retransmit_time( ezbus_mac_t* mac, const ezbus_address_t* address )
+{
+    ezbus_rtt_t* rtt = ezbus_peer_get_rtt( ezbus_mac_peers_lookup( mac, address ) );
+    if ( rtt != NULL && ezbus_rtt_measured( rtt ) )
+    {
+        /* a run of quick acks does not tighten the wait below the ring time */
+        uint32_t rtt_time = ezbus_rtt_timeout( rtt );
+        uint32_t ring_time = ezbus_mac_token_ring_time( mac );
+        return ( rtt_time > ring_time ) ? rtt_time : ring_time;
+    }
+    return ezbus_mac_token_retransmit_time( mac );
+}
+
 extern void ezbus_mac_peers_dump( ezbus_mac_t* mac, const char* prefix )
 {
     ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
@@ -211,6 +326,7 @@ static EZBUS_ERR ezbus_mac_peers_append( ezbus_mac_t* mac, const ezbus_peer_t* p
 
             ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
             ezbus_peer_copy( ezbus_mac_peers_at(mac,peers->count++), peer );
+            ezbus_mac_peers_refresh( mac );
 
             if ( ezbus_address_compare( ezbus_port_get_address(ezbus_mac_get_port(mac)), ezbus_peer_get_address( peer ) ) != 0 )
             {
@@ -243,6 +359,7 @@ static EZBUS_ERR ezbus_mac_peers_insert( ezbus_mac_t* mac, const ezbus_peer_t* p
             ezbus_peer_copy( dst, peer );
 
             ++peers->count;
+            ezbus_mac_peers_refresh( mac );
 
             if ( ezbus_address_compare( ezbus_port_get_address(ezbus_mac_get_port(mac)), ezbus_peer_get_address( peer ) ) != 0 )
             {
@@ -266,9 +383,10 @@ extern EZBUS_ERR ezbus_mac_peers_take( ezbus_mac_t* mac, int index )
 
         ezbus_peer_copy( &peer, ezbus_mac_peers_at(mac,index) );
         
-        bytes_to_move = (sizeof(ezbus_peer_t)*(ezbus_mac_peers_count(mac)-index));
+        bytes_to_move = (sizeof(ezbus_peer_t)*(ezbus_mac_peers_count(mac)-index-1));
         ezbus_platform.callback_memmove( &peers->list[ index ], &peers->list[ index+1 ], bytes_to_move );
         --peers->count;
+        ezbus_mac_peers_refresh( mac );
         
         if ( ezbus_address_compare( ezbus_port_get_address(ezbus_mac_get_port(mac)), ezbus_peer_get_address( &peer ) ) != 0 )
         {
@@ -310,12 +428,8 @@ extern bool ezbus_mac_peers_am_dominant( ezbus_mac_t* mac )
 
 extern void ezbus_mac_peers_crc( ezbus_mac_t* mac, ezbus_crc_t* crc )
 {
-    ezbus_crc_init( crc );
-    for(int index=0; index < ezbus_mac_peers_count(mac); index++)
-    {
-        ezbus_peer_t* peer = ezbus_mac_peers_at(mac,index);
-        ezbus_crc( crc, ezbus_peer_get_address( peer ), sizeof(ezbus_address_t) );
-    }
+    ezbus_mac_peers_t* peers = ezbus_mac_get_peers( mac );
+    *crc = peers->crc;
 }
 
 extern void ezbus_mac_peers_log( ezbus_mac_t* mac )
@@ -33,8 +33,11 @@ extern "C" {
 
 typedef struct _ezbus_mac_peers_t
 {
-    ezbus_peer_t        list[EZBUS_MAX_PEERS];
+    ezbus_peer_t        list[EZBUS_MAX_PEERS];      /* ascending address order */
     uint8_t             count;
+    int                 self;                       /* index of this node in list[], or -1 */
+    ezbus_address_t     successor;                  /* follows this node around the ring */
+    ezbus_crc_t         crc;                        /* over the addresses in list[], see ezbus_mac_peers_crc() */
 } ezbus_mac_peers_t;
 
 extern void  ezbus_mac_peers_init   ( ezbus_mac_t* mac );
@@ -64,10 +67,32 @@ extern bool             ezbus_mac_peers_am_dominant ( ezbus_mac_t* mac );
 
 /**
  * @brief locate the peer in the list which follows in sort order from the given address.
+ *        The successor of this node is kept from one insert or take to the next.
  * @return A pointer to the next peer, or NULL.
  */
 extern ezbus_address_t* ezbus_mac_peers_next    ( ezbus_mac_t* mac, const ezbus_address_t* address );
+/**
+ * @brief locate the first peer, following the given address around the ring, which has advertised 
+ *        demand for the token. This node is passed over.
+ * @return A pointer to the peer address, or NULL when no other peer wants the token.
+ */
+extern ezbus_address_t* ezbus_mac_peers_next_demand ( ezbus_mac_t* mac, const ezbus_address_t* address );
+/**
+ * @brief locate the first peer, following this node around the ring, with real-time traffic waiting.
+ * @return A pointer to the peer address, or NULL when no other peer has urgent traffic.
+ */
+extern ezbus_address_t* ezbus_mac_peers_next_urgent ( ezbus_mac_t* mac );
+extern void             ezbus_mac_peers_set_demand  ( ezbus_mac_t* mac, const ezbus_address_t* address, bool demand, bool urgent );
+extern void             ezbus_mac_peers_rtt_sample  ( ezbus_mac_t* mac, const ezbus_address_t* address, ezbus_ms_tick_t sample );
+/**
+ * @brief The wait for an ack from the peer, its measured round trip, no less than the ring time, or 
+ *        @ref ezbus_mac_token_retransmit_time() until a round trip has been measured.
+ */
+extern uint32_t         ezbus_mac_peers_retransmit_time( ezbus_mac_t* mac, const ezbus_address_t* address );
 extern void             ezbus_mac_peers_dump    ( ezbus_mac_t* mac, const char* prefix );
+/**
+ * @brief The checksum of the ring membership carried by the token, kept from one insert or take to the next.
+ */
 extern void             ezbus_mac_peers_crc     ( ezbus_mac_t* mac, ezbus_crc_t* crc );
 extern void             ezbus_mac_peers_log     ( ezbus_mac_t* mac );
 
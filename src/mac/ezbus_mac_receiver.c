@@ -103,7 +103,7 @@ static void do_receiver_state_empty( ezbus_mac_t* mac )
 	{
 		ezbus_mac_receiver_set_state( mac, receiver_state_full );
 	}
-	else
+	else if ( ezbus_mac_receiver_get_err( mac ) != EZBUS_ERR_NOTREADY ) /* else a frame still arriving stays in place */
 	{
 		ezbus_mac_receiver_set_state( mac, receiver_state_receive_fault );
 	}
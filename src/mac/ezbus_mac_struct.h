@@ -33,6 +33,7 @@
 #include <ezbus_mac_transmitter.h>
 #include <ezbus_mac_timer.h>
 #include <ezbus_mac_pause.h>
+#include <ezbus_socket_common.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,7 @@ struct _ezbus_mac_t
     ezbus_mac_token_t               token;
     ezbus_mac_timer_t               timer;
     ezbus_mac_pause_t               pause;
+    ezbus_socket_table_t            sockets;
 };
 
 typedef struct _ezbus_mac_t ezbus_mac_t;
@@ -23,140 +23,262 @@
 #include <ezbus_log.h>
 #include <ezbus_platform.h>
 
-static bool ezbus_timer_timeout   ( ezbus_timer_t* timer );
+#define ezbus_timer_bit(timer)          ((ezbus_timer_mask_t)1 << (timer)->index)
+#define ezbus_timer_wheel_slot(tick)    ((tick) & (EZBUS_TIMER_WHEEL_SLOTS-1))
+#define ezbus_timer_tick_due(tick,now)  ((int32_t)((now) - (tick)) >= 0)
+
 static void ezbus_timer_do_pausing( ezbus_timer_t* timer );
-static void ezbus_timer_do_paused ( ezbus_timer_t* timer );
 static void ezbus_timer_do_resume ( ezbus_timer_t* timer );
+static void ezbus_timer_do_step   ( ezbus_timer_t* timer );
+static void ezbus_timer_schedule  ( ezbus_timer_t* timer );
+static void ezbus_timer_unschedule( ezbus_timer_t* timer );
 
-static bool ezbus_timer_append    ( ezbus_mac_t* mac, ezbus_timer_t* timer );
-static bool ezbus_timer_remove    ( ezbus_mac_t* mac, ezbus_timer_t* timer );
+static int  ezbus_timer_append    ( ezbus_mac_t* mac, ezbus_timer_t* timer );
 static int  ezbus_timer_indexof   ( ezbus_mac_t* mac, ezbus_timer_t* timer );
 
 extern void ezbus_mac_timer_init( ezbus_mac_t* mac )
 {
     ezbus_mac_timer_t* mac_timer = ezbus_mac_get_timer( mac );
     ezbus_platform.callback_memset( mac_timer, 0, sizeof(ezbus_mac_timer_t) );
+    mac_timer->wheel_tick = ezbus_platform.callback_get_ms_ticks();
 }
 
 extern void ezbus_mac_timer_run( ezbus_mac_t* mac )
 {
     ezbus_mac_timer_t* mac_timer = ezbus_mac_get_timer(mac);
-    
-    for( int index=0; index < mac_timer->ezbus_timers_count; index++ )
+    ezbus_timer_mask_t pending   = mac_timer->pending;
+    ezbus_ms_tick_t    now       = ezbus_platform.callback_get_ms_ticks();
+    ezbus_ms_tick_t    elapsed   = now - mac_timer->wheel_tick;
+
+    /* sweep the slots from the last tick swept (timers overdue on arrival wait there) up to now */
+    if ( elapsed >= EZBUS_TIMER_WHEEL_SLOTS )
+    {
+        elapsed = EZBUS_TIMER_WHEEL_SLOTS-1;
+    }
+    for( ezbus_ms_tick_t tick = now - elapsed; ezbus_timer_tick_due( tick, now ); tick++ )
     {
-        ezbus_timer_t* timer = mac_timer->ezbus_timers[index];
-        switch( timer->state )
+        ezbus_timer_mask_t slot = mac_timer->wheel[ ezbus_timer_wheel_slot( tick ) ];
+        while ( slot )
         {
-            case state_timer_stopping:
-                // EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_stopping  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
-                ezbus_timer_set_state( timer, state_timer_stopped );
-                break;
-            case state_timer_stopped:
-                break;
-            case state_timer_starting:
-                // EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_starting [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
-                timer->start = ezbus_timer_get_ticks( timer );
-                ezbus_timer_set_state( timer, state_timer_started );
-                break;
-            case state_timer_started:
-                if ( ezbus_timer_timeout( timer ) )
+            ezbus_timer_t* timer = mac_timer->ezbus_timers[ __builtin_ctz( slot ) ];
+            slot &= slot-1;
+            if ( timer->slot != ezbus_timer_wheel_slot( tick ) )
+            {
+                /* left behind when the timer's owner cleared it */
+                mac_timer->wheel[ ezbus_timer_wheel_slot( tick ) ] &= ~ezbus_timer_bit( timer );
+            }
+            else if ( ezbus_timer_tick_due( timer->deadline, now ) )
+            {
+                if ( timer->state == state_timer_started )
                 {
                     EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_started  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
                     ezbus_timer_set_state( timer, state_timer_expiring );
                 }
-                break;
-            case state_timer_pausing:
-                EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_pausing  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
-                ezbus_timer_do_pausing( timer );
-                ezbus_timer_set_state( timer, state_timer_paused );
-                break;
-            case state_timer_paused:
-                ezbus_timer_do_paused( timer );
-                break;
-            case state_timer_resume:
-                EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_resume   [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
-                ezbus_timer_do_resume( timer );
-                //ezbus_timer_set_state( timer, state_timer_started );
-                break;
-            case state_timer_expiring:
-                EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_expiring [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
-                ezbus_timer_set_state( timer, state_timer_expired );
-                break;
-            case state_timer_expired:
-                EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_expired  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
-                if ( timer->callback )
-                    timer->callback( timer, timer->arg );
-                //ezbus_timer_set_state( timer, state_timer_stopping );
-                break;
+                else
+                {
+                    ezbus_timer_resume( timer );
+                }
+            }
+        }
+    }
+    mac_timer->wheel_tick = now;
+
+    /* one state transition per pass, for those timers which were pending as the pass began */
+    while ( pending )
+    {
+        ezbus_timer_t* timer = mac_timer->ezbus_timers[ __builtin_ctz( pending ) ];
+        pending &= pending-1;
+        if ( mac_timer->pending & ezbus_timer_bit( timer ) )
+        {
+            ezbus_timer_do_step( timer );
         }
     }
 }
 
-extern void ezbus_mac_timer_setup( ezbus_mac_t* mac, ezbus_timer_t* timer, bool pausable )
+static void ezbus_timer_do_step( ezbus_timer_t* timer )
 {
-    ezbus_platform.callback_memset( timer, 0, sizeof(ezbus_timer_t) );
-    ezbus_timer_append( mac, timer );
-    ezbus_timer_set_pausable( timer, pausable );
+    switch( timer->state )
+    {
+        case state_timer_stopping:
+            // EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_stopping  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
+            ezbus_timer_set_state( timer, state_timer_stopped );
+            break;
+        case state_timer_starting:
+            // EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_starting [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
+            timer->start = ezbus_timer_get_ticks( timer );
+            ezbus_timer_set_state( timer, state_timer_started );
+            break;
+        case state_timer_pausing:
+            EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_pausing  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
+            ezbus_timer_do_pausing( timer );
+            ezbus_timer_set_state( timer, state_timer_paused );
+            break;
+        case state_timer_resume:
+            EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_resume   [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
+            ezbus_timer_do_resume( timer );
+            break;
+        case state_timer_expiring:
+            EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_expiring [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
+            ezbus_timer_set_state( timer, state_timer_expired );
+            break;
+        case state_timer_expired:
+            /* remains pending, and so keeps calling back, until the callback moves it on */
+            EZBUS_LOG( EZBUS_LOG_TIMERS, "state_timer_expired  [%08X,%08X] - %s", timer->callback, timer->arg, ezbus_timer_get_key( timer ) );
+            if ( timer->callback )
+                timer->callback( timer, timer->arg );
+            break;
+        default:
+            ezbus_timer_schedule( timer );
+            break;
+    }
 }
 
-static bool ezbus_timer_append( ezbus_mac_t* mac, ezbus_timer_t* timer )
+/**
+ * @brief Determine the number of milli-seconds until the earliest timer requires service.
+ * @return 0 when a timer has a state transition pending, else the time remaining until the
+ *         first running timer expires, else EZBUS_TIMER_FOREVER when no timer is running.
+ */
+extern ezbus_ms_tick_t ezbus_mac_timer_next_expiry( ezbus_mac_t* mac )
 {
     ezbus_mac_timer_t* mac_timer = ezbus_mac_get_timer(mac);
+    ezbus_ms_tick_t    now       = ezbus_platform.callback_get_ms_ticks();
+    ezbus_ms_tick_t    next      = EZBUS_TIMER_FOREVER;
 
-    if ( ezbus_timer_indexof( mac, timer ) < 0 )
+    if ( mac_timer->pending )
     {
-        mac_timer->ezbus_timers = 
-            (ezbus_timer_t**)ezbus_platform.callback_realloc( 
-                mac_timer->ezbus_timers, 
-                ( sizeof(ezbus_timer_t*) * (++mac_timer->ezbus_timers_count) )
-            );
-
-        if ( mac_timer->ezbus_timers != NULL )
+        return 0;
+    }
+    for( int slot=0; slot < EZBUS_TIMER_WHEEL_SLOTS && next > 0; slot++ )
+    {
+        ezbus_timer_mask_t mask = mac_timer->wheel[ slot ];
+        while ( mask )
         {
-            int index = mac_timer->ezbus_timers_count-1;
-            mac_timer->ezbus_timers[index] = timer;  
-            return true;
+            ezbus_timer_t* timer = mac_timer->ezbus_timers[ __builtin_ctz( mask ) ];
+            ezbus_ms_tick_t remaining = ezbus_timer_tick_due( timer->deadline, now ) ? 0 : timer->deadline - now;
+            mask &= mask-1;
+            if ( remaining < next )
+            {
+                next = remaining;
+            }
         }
+    }
+    return next;
+}
+
+extern void ezbus_mac_timer_setup( ezbus_mac_t* mac, ezbus_timer_t* timer, bool pausable )
+{
+    int index = ezbus_timer_indexof( mac, timer );
 
-        return false;
+    if ( index >= 0 )
+    {
+        /* set up once more, ex. after the owner was cleared, so drop what the wheel knew of it */
+        ezbus_mac_timer_t* mac_timer = ezbus_mac_get_timer( mac );
+        mac_timer->pending &= ~((ezbus_timer_mask_t)1 << index);
+        for( int slot=0; slot < EZBUS_TIMER_WHEEL_SLOTS; slot++ )
+        {
+            mac_timer->wheel[ slot ] &= ~((ezbus_timer_mask_t)1 << index);
+        }
     }
-    return true;
+    ezbus_platform.callback_memset( timer, 0, sizeof(ezbus_timer_t) );
+    timer->slot = EZBUS_TIMER_WHEEL_SLOTS;
+    if ( (index = ezbus_timer_append( mac, timer )) >= 0 )
+    {
+        timer->index     = index;
+        timer->mac_timer = ezbus_mac_get_timer( mac );
+    }
+    ezbus_timer_set_pausable( timer, pausable );
+    ezbus_timer_set_state( timer, state_timer_stopping );
 }
 
-static bool ezbus_timer_remove( ezbus_mac_t* mac, ezbus_timer_t* timer )
+static int ezbus_timer_append( ezbus_mac_t* mac, ezbus_timer_t* timer )
 {
     ezbus_mac_timer_t* mac_timer = ezbus_mac_get_timer(mac);
-    uint32_t index = ezbus_timer_indexof( mac, timer );
+    int index = ezbus_timer_indexof( mac, timer );
 
-    if ( index >= 0 )
+    if ( index < 0 && mac_timer->ezbus_timers_count < EZBUS_MAX_TIMERS )
     {
-        ezbus_platform.callback_memmove( &mac_timer->ezbus_timers[index], &mac_timer->ezbus_timers[index+1], (--mac_timer->ezbus_timers_count)-index );
-        mac_timer->ezbus_timers = (ezbus_timer_t**)ezbus_platform.callback_realloc( mac_timer->ezbus_timers, ( sizeof(ezbus_timer_t*) * mac_timer->ezbus_timers_count ) );
-        return true;
+        index = mac_timer->ezbus_timers_count++;
+        mac_timer->ezbus_timers[index] = timer;  
     }
-    return false;
+    else if ( index < 0 )
+    {
+        EZBUS_LOG( EZBUS_LOG_TIMERS, "%s - %s", ezbus_timer_get_key( timer ), ezbus_fault_str( EZBUS_ERR_LIMIT ) );
+    }
+    return index;
 }
 
 static int ezbus_timer_indexof( ezbus_mac_t* mac, ezbus_timer_t* timer )
 {
     ezbus_mac_timer_t* mac_timer = ezbus_mac_get_timer(mac);
 
-    if ( mac_timer->ezbus_timers != NULL && mac_timer->ezbus_timers_count > 0 )
+    for( int index=0; index < mac_timer->ezbus_timers_count; index++ )
     {
-        for( uint32_t index=0; index < mac_timer->ezbus_timers_count; index++ )
+        if ( mac_timer->ezbus_timers[index] == timer )
         {
-            if ( mac_timer->ezbus_timers[index] == timer )
-            {
-                return index;
-            }
+            return index;
         }
     }
     return -1; 
 }
 
+/**
+ * @brief Take the timer off the wheel and out of the pending set.
+ */
+static void ezbus_timer_unschedule( ezbus_timer_t* timer )
+{
+    ezbus_mac_timer_t* mac_timer = timer->mac_timer;
+
+    mac_timer->pending &= ~ezbus_timer_bit( timer );
+    if ( timer->slot < EZBUS_TIMER_WHEEL_SLOTS )
+    {
+        mac_timer->wheel[ timer->slot ] &= ~ezbus_timer_bit( timer );
+        timer->slot = EZBUS_TIMER_WHEEL_SLOTS;
+    }
+}
+
+/**
+ * @brief File the timer according to it's state, running and timed pause on the wheel, 
+ *          transitional states in the pending set, and stopped nowhere.
+ */
+static void ezbus_timer_schedule( ezbus_timer_t* timer )
+{
+    ezbus_mac_timer_t* mac_timer = timer->mac_timer;
+
+    if ( mac_timer == NULL )
+    {
+        return;
+    }
+
+    ezbus_timer_unschedule( timer );
+    switch( timer->state )
+    {
+        case state_timer_stopped:
+            return;
+        case state_timer_started:
+            /* a period has elapsed once more than 'period' ticks have passed */
+            timer->deadline = timer->start + timer->period + 1;
+            break;
+        case state_timer_paused:
+            if ( !ezbus_timer_get_pause_duration( timer ) )
+            {
+                return;
+            }
+            timer->deadline = timer->pause_start + ezbus_timer_get_pause_duration( timer ) + 1;
+            break;
+        default:
+            mac_timer->pending |= ezbus_timer_bit( timer );
+            return;
+    }
+    timer->slot = ezbus_timer_tick_due( timer->deadline, mac_timer->wheel_tick ) ? 
+                    ezbus_timer_wheel_slot( mac_timer->wheel_tick ) : 
+                    ezbus_timer_wheel_slot( timer->deadline );
+    mac_timer->wheel[ timer->slot ] |= ezbus_timer_bit( timer );
+}
+
 extern void ezbus_timer_set_state( ezbus_timer_t* timer, ezbus_timer_state_t state )
 {
     timer->state = state;
+    ezbus_timer_schedule( timer );
 }
 
 extern ezbus_timer_state_t ezbus_timer_get_state( ezbus_timer_t* timer )
@@ -188,7 +310,14 @@ extern char* ezbus_timer_get_key( ezbus_timer_t* timer )
 
 extern void ezbus_timer_set_period( ezbus_timer_t* timer, ezbus_ms_tick_t period )
 {
-    timer->period = period;
+    if ( timer->period != period )
+    {
+        timer->period = period;
+        if ( timer->state == state_timer_started )
+        {
+            ezbus_timer_schedule( timer );
+        }
+    }
 }
 
 extern ezbus_ms_tick_t ezbus_timer_get_period( ezbus_timer_t* timer )
@@ -214,7 +343,14 @@ extern bool ezbus_timer_get_pausable( ezbus_timer_t* timer )
 
 extern void ezbus_timer_set_pause_duration( ezbus_timer_t* timer, ezbus_ms_tick_t pause_duration )
 {
-    timer->pause_duration = pause_duration;
+    if ( timer->pause_duration != pause_duration )
+    {
+        timer->pause_duration = pause_duration;
+        if ( timer->state == state_timer_paused )
+        {
+            ezbus_timer_schedule( timer );
+        }
+    }
 }
 
 extern ezbus_ms_tick_t ezbus_timer_get_pause_duration( ezbus_timer_t* timer )
@@ -287,28 +423,12 @@ extern void ezbus_timer_resume( ezbus_timer_t* timer )
     }
 }
 
-static bool ezbus_timer_timeout( ezbus_timer_t* timer ) 
-{
-    return (ezbus_timer_get_ticks(timer) - (timer)->start) > timer->period;
-}
-
 static void ezbus_timer_do_pausing( ezbus_timer_t* timer )
 {
     /* preserve the timer state */
     timer->pause_start = ezbus_timer_get_ticks( timer );
 }
 
-static void ezbus_timer_do_paused ( ezbus_timer_t* timer )
-{
-    if ( ezbus_timer_get_pause_duration( timer ) )
-    {
-        if ( ( ezbus_timer_get_ticks( timer ) - timer->pause_start ) > ezbus_timer_get_pause_duration( timer ) )
-        {
-            ezbus_timer_resume( timer );
-        }
-    }
-}
-
 static void ezbus_timer_do_resume( ezbus_timer_t* timer )
 {
     ezbus_ms_tick_t pause_delta = (timer->pause_start - timer->start);
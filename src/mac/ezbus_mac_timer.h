@@ -42,6 +42,10 @@ typedef enum
     state_timer_expired
 } ezbus_timer_state_t;
 
+typedef uint32_t ezbus_timer_mask_t;            /* one bit per timer, see EZBUS_MAX_TIMERS */
+
+struct _ezbus_mac_timer_t;
+
 typedef struct _ezbus_timer_t
 {
     ezbus_ms_tick_t     start;
@@ -54,13 +58,27 @@ typedef struct _ezbus_timer_t
     ezbus_timer_state_t state;
     char*               key;
     bool                pausable;
+
+    struct _ezbus_mac_timer_t* mac_timer;   /* the wheel this timer is scheduled on */
+    ezbus_ms_tick_t     deadline;           /* tick at which the wheel next services this timer */
+    uint8_t             index;              /* bit in the wheel's masks */
+    uint8_t             slot;               /* wheel slot, or EZBUS_TIMER_WHEEL_SLOTS when not on the wheel */
 } ezbus_timer_t;
 
+/**
+ * A hashed timer wheel. Running timers sit in the slot of their deadline tick, and timers with
+ * a state transition to make are marked pending, so a pass over the wheel only visits the slots
+ * for the ticks which have elapsed, and never visits a stopped timer.
+ */
 typedef struct _ezbus_mac_timer_t
 {
-    ezbus_timer_t**  ezbus_timers;
-    int              ezbus_timers_count;
-    bool             ezbus_timers_pause_active;
+    ezbus_timer_t*      ezbus_timers[EZBUS_MAX_TIMERS];
+    int                 ezbus_timers_count;
+    bool                ezbus_timers_pause_active;
+
+    ezbus_timer_mask_t  pending;
+    ezbus_timer_mask_t  wheel[EZBUS_TIMER_WHEEL_SLOTS];
+    ezbus_ms_tick_t     wheel_tick;                     /* last tick swept */
 } ezbus_mac_timer_t;
 
 
@@ -68,6 +86,7 @@ typedef void (*ezbus_timer_callback_t) ( struct _ezbus_timer_t*, void* );
 
 extern void                 ezbus_mac_timer_init            ( ezbus_mac_t* mac ); 
 extern void                 ezbus_mac_timer_run             ( ezbus_mac_t* mac );
+extern ezbus_ms_tick_t      ezbus_mac_timer_next_expiry     ( ezbus_mac_t* mac );
 
 extern void                 ezbus_mac_timer_setup           ( ezbus_mac_t* mac, ezbus_timer_t* timer, bool pausable );
 extern void                 ezbus_timer_set_state           ( ezbus_timer_t* timer, ezbus_timer_state_t state );
@@ -25,8 +25,6 @@
 #include <ezbus_log.h>
 #include <ezbus_platform.h>
 
-#define NUM_PEERS_HACK  500       // use for debugging / testing.
-
 #define ezbus_mac_token_get_ring_timer(token)  (&(token)->ring_timer)
 
 static void ezbus_mac_token_ring_timer_callback( ezbus_timer_t* timer, void* arg );
@@ -37,7 +35,7 @@ extern void ezbus_mac_token_init( ezbus_mac_t* mac )
     ezbus_platform.callback_memset( token, 0, sizeof(ezbus_mac_token_t) );
     ezbus_mac_timer_setup( mac, ezbus_mac_token_get_ring_timer(token), true );
     ezbus_timer_set_key( ezbus_mac_token_get_ring_timer(token), "ring_timer" );
-    ezbus_timer_set_period( ezbus_mac_token_get_ring_timer(token), 500 /* ezbus_mac_token_ring_time(mac) */ );
+    ezbus_timer_set_period( ezbus_mac_token_get_ring_timer(token), ezbus_mac_token_ring_time(mac) );
     ezbus_timer_set_callback( ezbus_mac_token_get_ring_timer(token), ezbus_mac_token_ring_timer_callback, mac );
 }
 
@@ -59,28 +57,42 @@ extern bool ezbus_mac_token_ring_count_timeout( ezbus_mac_t* mac, uint32_t start
     return ( delta_count > timeout_count );
 }
 
+static uint32_t ezbus_mac_token_wire_time( ezbus_mac_t* mac, uint32_t bytes )
+{
+    uint32_t speed = ezbus_port_get_speed( ezbus_mac_get_port(mac) );
+    return (uint32_t)( ( ( (uint64_t)bytes * EZBUS_WIRE_BYTE_BITS * 1000 ) + speed - 1 ) / speed );
+}
+
+extern uint32_t ezbus_mac_token_rotation_time( ezbus_mac_t* mac )
+{
+    ezbus_mac_token_t* token = ezbus_mac_get_token( mac );
+    return ezbus_rtt_timeout( &token->rotation );
+}
+
 extern uint32_t ezbus_mac_token_ring_time( ezbus_mac_t* mac )
 {
-    #if NUM_PEERS_HACK
-        return NUM_PEERS_HACK;
-    #else
-        uint32_t packet_sz = sizeof(ezbus_header_t);
-        #if NUM_PEERS_HACK
-            uint32_t packets_per_round = EZBUS_MAX_PEERS * 2; 
-        #else
-            uint32_t packets_per_round = ( ezbus_mac_peers_count(mac) * 2);
-        #endif
-        float    bit_time_sec      = 1.0f/(float)ezbus_port_get_speed( ezbus_mac_get_port(mac) );
-        float    packet_bits       = ((float)packet_sz * 12.0f);
-        float    packet_time_sec   = packet_bits * bit_time_sec;
-        float    secs_per_round    = packet_time_sec * (float)packets_per_round;
-        return (int)((secs_per_round * 1000.0f) + 1.0f);
-    #endif
+    uint32_t rotation_time = ezbus_mac_token_rotation_time( mac );
+    uint32_t peers = ezbus_mac_peers_count( mac ) ? ezbus_mac_peers_count( mac ) : EZBUS_ASSUMED_PEERS;
+    uint32_t floor_time;
+
+    if ( rotation_time == 0 )
+    {
+        return EZBUS_TOKEN_RING_TIME;
+    }
+
+    /* the longest silence on a live ring is one maximum frame, then the token around every peer */
+    floor_time = ezbus_mac_token_wire_time( mac, sizeof(ezbus_packet_t) + ( peers * 2 * sizeof(ezbus_header_t) ) ) + 1;
+    if ( rotation_time < floor_time )
+    {
+        rotation_time = floor_time;
+    }
+    return ( rotation_time < EZBUS_TOKEN_RING_TIME ) ? rotation_time : EZBUS_TOKEN_RING_TIME;
 }
 
 extern uint32_t ezbus_mac_token_retransmit_time ( ezbus_mac_t* mac )
 {
-    return ezbus_mac_token_ring_time( mac ) * 4;
+    /* the recipient acks on its next hold, after this node's own hold has been sent out */
+    return ( ezbus_mac_token_ring_time( mac ) * 4 ) + ezbus_mac_token_wire_time( mac, ezbus_mac_arbiter_get_token_budget( mac ) );
 }
 
 extern void ezbus_mac_token_reset( ezbus_mac_t* mac )
@@ -92,6 +104,17 @@ extern void ezbus_mac_token_reset( ezbus_mac_t* mac )
 extern void ezbus_mac_token_acquire( ezbus_mac_t* mac )
 {
     ezbus_mac_token_t* token = ezbus_mac_get_token( mac );
+    ezbus_ms_tick_t now = ezbus_platform.callback_get_ms_ticks();
+    if ( ezbus_mac_arbiter_online( mac ) && !token->acquired && token->ring_count )
+    {
+        /* a rotation straddling a boot is not a sample, nor is one as long as a pause might make it */
+        uint32_t sample = now - token->acquire_time;
+        if ( sample <= EZBUS_TOKEN_RING_TIME * 4 )
+        {
+            ezbus_rtt_sample( &token->rotation, sample );
+        }
+    }
+    token->acquire_time = now;
     ++token->ring_count;
     ezbus_timer_restart( ezbus_mac_token_get_ring_timer(token) );
     token->acquired=true;
@@ -25,12 +25,15 @@
 #include <ezbus_types.h>
 #include <ezbus_mac.h>
 #include <ezbus_mac_timer.h>
+#include <ezbus_rtt.h>
 
 typedef struct _ezbus_mac_token_t
 {
     ezbus_timer_t   ring_timer;
     uint32_t        ring_count;
     bool            acquired;
+    ezbus_ms_tick_t acquire_time;       /* when this node last took the token */
+    ezbus_rtt_t     rotation;           /* time from one hold of the token to the next */
 } ezbus_mac_token_t;
 
 #ifdef __cplusplus
@@ -48,7 +51,19 @@ extern bool     ezbus_mac_token_acquired            ( ezbus_mac_t* mac );
 extern uint32_t ezbus_mac_token_ring_count          ( ezbus_mac_t* mac );
 extern bool     ezbus_mac_token_ring_count_timeout  ( ezbus_mac_t* mac, uint32_t start_count, uint32_t timeout_count );
 
+/**
+ * @brief The rotation time of the token as seen from this node, smoothed mean plus four mean deviations, ms.
+ * @return 0 until a rotation has been measured.
+ */
+extern uint32_t ezbus_mac_token_rotation_time       ( ezbus_mac_t* mac );
+/**
+ * @brief The silence after which the token is presumed lost, the measured rotation time, no less than
+ *        the longest frame plus a token hop per live peer at the port speed, and no more than EZBUS_TOKEN_RING_TIME.
+ */
 extern uint32_t ezbus_mac_token_ring_time           ( ezbus_mac_t* mac );
+/**
+ * @brief The wait for an acknowledgement, four ring times plus the wire time of this node's token hold.
+ */
 extern uint32_t ezbus_mac_token_retransmit_time     ( ezbus_mac_t* mac );
 
 #ifdef __cplusplus
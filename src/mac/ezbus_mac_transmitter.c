@@ -20,67 +20,264 @@
 * DEALINGS IN THE SOFTWARE.                                                  *
 *****************************************************************************/
 #include <ezbus_mac_transmitter.h>
+#include <ezbus_mac_arbiter.h>
 #include <ezbus_hex.h>
 #include <ezbus_log.h>
 #include <ezbus_platform.h>
 
 static void ezbus_mac_transmitter_set_err                 ( ezbus_mac_t* mac, EZBUS_ERR err );
+static void ezbus_mac_transmitter_pop                     ( ezbus_mac_t* mac );
 static void do_mac_transmitter_state_send                 ( ezbus_mac_t* mac );
 static void do_mac_transmitter_state_sent                 ( ezbus_mac_t* mac );
+static ezbus_mac_transmitter_priority_t ezbus_mac_transmitter_priority ( ezbus_packet_t* packet );
+static bool ezbus_mac_transmitter_queue                   ( ezbus_mac_t* mac, ezbus_packet_t* packet, bool ref );
+static uint8_t ezbus_mac_transmitter_first                ( ezbus_mac_t* mac );
 
 void ezbus_mac_transmitter_init( ezbus_mac_t* mac )
 {
     ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
 
     ezbus_platform.callback_memset(transmitter,0,sizeof(ezbus_mac_transmitter_t));
+    for( uint8_t slot=0; slot < EZBUS_TRANSMIT_QUEUE; slot++ )
+    {
+        transmitter->order[slot] = slot;
+        transmitter->frame[slot] = ezbus_packet_control( &transmitter->queue[slot] );
+    }
 }
 
 void ezbus_mac_transmitter_run ( ezbus_mac_t* mac )
 {
     static ezbus_mac_transmitter_state_t transmitter_state=(ezbus_mac_transmitter_state_t)0xff;
+    int steps=0;
+
+    /* 
+     * Once online, drain the queue back-to-back while the token is held rather 
+     * than one state per pass through ezbus_mac_run(). Three steps move one frame.
+     * The boot states keep the original one step per pass timing.
+     */
+    do
+    {
+        if ( ezbus_mac_transmitter_get_state( mac ) != transmitter_state )
+        {
+            EZBUS_LOG( EZBUS_LOG_TRANSMITTERSTATE, "%s", ezbus_mac_transmitter_get_state_str(mac) );
+            transmitter_state = ezbus_mac_transmitter_get_state( mac );
+        }
+
+        switch( ezbus_mac_transmitter_get_state( mac ) )
+        {
+            
+            case transmitter_state_empty:   
+                ezbus_mac_transmitter_signal_empty( mac );
+                break;
+            
+            case transmitter_state_full:
+                ezbus_mac_transmitter_signal_full( mac );
+                ezbus_mac_transmitter_set_state( mac, transmitter_state_send );
+                break;
+            
+            case transmitter_state_send:
+                do_mac_transmitter_state_send( mac );
+               break;
+            
+            case transmitter_state_sent:
+                do_mac_transmitter_state_sent( mac );
+                break;
+        }
+    } while ( ezbus_mac_arbiter_online( mac ) && !ezbus_mac_transmitter_empty( mac ) && ++steps < EZBUS_TRANSMIT_QUEUE*3 );
+}
+
+/**
+ * @brief Queue a copy of a control frame, the caller's packet may be reused on return.
+ * @return false if the frame was not queued, the queue was full or the frame too large.
+ */
+extern bool ezbus_mac_transmitter_put( ezbus_mac_t* mac, ezbus_packet_t* packet )
+{
+    return ezbus_mac_transmitter_queue( mac, packet, false );
+}
+
+/**
+ * @brief Queue the packet itself without copying it. The packet must stay put until
+ *        it has been sent, or until ezbus_mac_transmitter_drop() has taken it back.
+ * @return false if the queue was full, the packet was not queued.
+ */
+extern bool ezbus_mac_transmitter_put_ref( ezbus_mac_t* mac, ezbus_packet_t* packet )
+{
+    return ezbus_mac_transmitter_queue( mac, packet, true );
+}
+
+/**
+ * @brief Take back any queued references to the packet so that it may be rewritten.
+ * @return false if the packet is on its way out on the wire right now.
+ */
+extern bool ezbus_mac_transmitter_drop( ezbus_mac_t* mac, ezbus_packet_t* packet )
+{
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+    uint8_t first = ezbus_mac_transmitter_first( mac );
+
+    if ( first && transmitter->frame[ transmitter->order[0] ] == packet )
+    {
+        return false;
+    }
+
+    for( uint8_t pos=first; pos < transmitter->count; )
+    {
+        uint8_t slot = transmitter->order[pos];
+        if ( transmitter->frame[slot] == packet )
+        {
+            --transmitter->count;
+            for( uint8_t next=pos; next < transmitter->count; next++ )
+            {
+                transmitter->order[next] = transmitter->order[next+1];
+            }
+            transmitter->order[ transmitter->count ] = slot;
+            transmitter->frame[ slot ] = ezbus_packet_control( &transmitter->queue[ slot ] );
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+
+    if ( !transmitter->count && !first )
+    {
+        ezbus_mac_transmitter_set_state( mac, transmitter_state_empty );
+    }
+    return true;
+}
+
+static bool ezbus_mac_transmitter_queue( ezbus_mac_t* mac, ezbus_packet_t* packet, bool ref )
+{
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+    ezbus_mac_transmitter_priority_t priority = ezbus_mac_transmitter_priority( packet );
+    uint8_t first = ezbus_mac_transmitter_first( mac );
+
+    if ( priority == transmitter_priority_control && !ref )
+    {
+        /* 
+         * a control frame still waiting is stale, the latest one of its type to the same 
+         * peer and socket replaces it, there is only ever one token to hand on.
+         */
+        bool token = ( ezbus_packet_type( packet ) == packet_type_give_token || 
+                       ezbus_packet_type( packet ) == packet_type_take_token );
+        for( uint8_t pos=first; pos < transmitter->count; pos++ )
+        {
+            uint8_t slot = transmitter->order[pos];
+            ezbus_packet_t* queued = transmitter->frame[ slot ];
+            if ( queued == ezbus_packet_control( &transmitter->queue[ slot ] ) && ezbus_packet_type( queued ) == ezbus_packet_type( packet ) &&
+                 ( token || ( ezbus_address_compare( ezbus_packet_dst( queued ), ezbus_packet_dst( packet ) ) == 0 &&
+                              ezbus_packet_dst_socket( queued ) == ezbus_packet_dst_socket( packet ) ) ) )
+            {
+                ezbus_packet_copy( queued, packet );
+                return true;
+            }
+        }
+    }
 
-    if ( ezbus_mac_transmitter_get_state( mac ) != transmitter_state )
+    if ( !ref && ezbus_packet_tx_size( packet ) > sizeof( ezbus_packet_control_t ) )
     {
-        EZBUS_LOG( EZBUS_LOG_TRANSMITTERSTATE, "%s", ezbus_mac_transmitter_get_state_str(mac) );
-        transmitter_state = ezbus_mac_transmitter_get_state( mac );
+        /* only control frames are copied, parcels with a payload are put by reference */
+        EZBUS_LOG( EZBUS_LOG_TRANSMITTER, "oversize %d", ezbus_packet_type( packet ) );
+        ezbus_mac_transmitter_set_err( mac, EZBUS_ERR_LIMIT );
+        return false;
     }
+    else if ( transmitter->count < EZBUS_TRANSMIT_QUEUE )
+    {
+        uint8_t slot  = transmitter->order[ transmitter->count ];
+        uint8_t pos   = transmitter->count++;
+
+        if ( ref )
+        {
+            transmitter->frame[ slot ] = packet;
+        }
+        else
+        {
+            transmitter->frame[ slot ] = ezbus_packet_control( &transmitter->queue[ slot ] );
+            ezbus_packet_copy( transmitter->frame[ slot ], packet );
+        }
+
+        while ( pos > first && ezbus_mac_transmitter_priority( transmitter->frame[ transmitter->order[pos-1] ] ) < priority )
+        {
+            transmitter->order[pos] = transmitter->order[pos-1];
+            --pos;
+        }
+        transmitter->order[pos] = slot;
 
-    switch( ezbus_mac_transmitter_get_state( mac ) )
-    {
-        
-        case transmitter_state_empty:   
-            ezbus_mac_transmitter_signal_empty( mac );
-            break;
-        
-        case transmitter_state_full:
-            ezbus_mac_transmitter_signal_full( mac );
-            ezbus_mac_transmitter_set_state( mac, transmitter_state_send );
-            break;
-        
-        case transmitter_state_send:
-            do_mac_transmitter_state_send( mac );
-           break;
-        
-        case transmitter_state_sent:
-            do_mac_transmitter_state_sent( mac );
-            break;
+        if ( ezbus_mac_transmitter_empty( mac ) )
+        {
+            ezbus_mac_transmitter_set_state( mac, transmitter_state_full );
+        }
+        return true;
     }
+    EZBUS_LOG( EZBUS_LOG_TRANSMITTER, "overflow %d", ezbus_packet_type( packet ) );
+    ezbus_mac_transmitter_set_err( mac, EZBUS_ERR_OVERFLOW );
+    return false;
+}
+
+/* the head may not be overtaken or withdrawn once it is on its way out */
+static uint8_t ezbus_mac_transmitter_first( ezbus_mac_t* mac )
+{
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+    return ( transmitter->count && ( transmitter->state == transmitter_state_send || 
+                                     transmitter->state == transmitter_state_sent ) ) ? 1 : 0;
+}
+
+extern uint8_t ezbus_mac_transmitter_count( ezbus_mac_t* mac )
+{
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+    return transmitter->count;
 }
 
-extern void ezbus_mac_transmitter_put( ezbus_mac_t* mac, ezbus_packet_t* packet )
+extern uint32_t ezbus_mac_transmitter_bytes( ezbus_mac_t* mac )
 {
-    ezbus_packet_copy( ezbus_mac_get_transmitter_packet( mac ), packet );
-    ezbus_mac_transmitter_set_state( mac, transmitter_state_full );
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+    uint32_t bytes = 0;
+    for( uint8_t n=0; n < transmitter->count; n++ )
+    {
+        bytes += ezbus_packet_tx_size( transmitter->frame[ transmitter->order[n] ] );
+    }
+    return bytes;
 }
 
 extern void  ezbus_mac_transmitter_reload( ezbus_mac_t* mac )
 {
-    ezbus_mac_transmitter_set_state( mac, transmitter_state_full );
+    if ( ezbus_mac_transmitter_count( mac ) )
+    {
+        ezbus_mac_transmitter_set_state( mac, transmitter_state_full );
+    }
 }
 
 extern void ezbus_mac_transmitter_reset( ezbus_mac_t* mac )
 {
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+    transmitter->count = 0;
     ezbus_mac_transmitter_set_state( mac, transmitter_state_empty );
+    ezbus_mac_transmitter_signal_release( mac, NULL );
+}
+
+static void ezbus_mac_transmitter_pop( ezbus_mac_t* mac )
+{
+    ezbus_mac_transmitter_t* transmitter = ezbus_mac_get_transmitter( mac );
+
+    if ( transmitter->count )
+    {
+        uint8_t slot = transmitter->order[0];
+        --transmitter->count;
+        for( uint8_t pos=0; pos < transmitter->count; pos++ )
+        {
+            transmitter->order[pos] = transmitter->order[pos+1];
+        }
+        transmitter->order[ transmitter->count ] = slot;
+    }
+    ezbus_mac_transmitter_set_state( mac, transmitter->count ? transmitter_state_full : transmitter_state_empty );
+}
+
+static ezbus_mac_transmitter_priority_t ezbus_mac_transmitter_priority( ezbus_packet_t* packet )
+{
+    if ( ezbus_packet_type( packet ) == packet_type_parcel )
+    {
+        return ezbus_packet_urgent( packet ) ? transmitter_priority_urgent : transmitter_priority_data;
+    }
+    return transmitter_priority_control;
 }
 
 
@@ -109,7 +306,8 @@ static void do_mac_transmitter_state_sent( ezbus_mac_t* mac )
             ezbus_mac_transmitter_signal_wait( mac );
         }
     }
-    ezbus_mac_transmitter_reset( mac );
+    ezbus_mac_transmitter_pop( mac );
+    ezbus_mac_transmitter_signal_release( mac, tx_packet );
 }
 
 
@@ -25,6 +25,7 @@
 
 #include <ezbus_types.h>
 #include <ezbus_mac.h>
+#include <ezbus_packet.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,18 +39,33 @@ typedef enum
     transmitter_state_sent,
 } ezbus_mac_transmitter_state_t;
 
+typedef enum
+{
+    transmitter_priority_data=0,        /* parcels, first in first out */
+    transmitter_priority_urgent,        /* parcels of real-time sockets, ahead of bulk data */
+    transmitter_priority_control,       /* ack, nack, token..., ahead of any queued data */
+} ezbus_mac_transmitter_priority_t;
+
 typedef struct _ezbus_mac_transmitter_t
 {
-    ezbus_packet_t                      packet;
+    ezbus_packet_control_t              queue[ EZBUS_TRANSMIT_QUEUE ];  /* control frames put by copy */
+    ezbus_packet_t*                     frame[ EZBUS_TRANSMIT_QUEUE ];  /* per slot, queue[slot] or a packet put by reference */
+    uint8_t                             order[ EZBUS_TRANSMIT_QUEUE ];  /* queue slots, head first */
+    uint8_t                             count;
     ezbus_mac_transmitter_state_t       state;
     EZBUS_ERR                           err;
 } ezbus_mac_transmitter_t;
 
 extern void  ezbus_mac_transmitter_init     ( ezbus_mac_t* mac );
 extern void  ezbus_mac_transmitter_run      ( ezbus_mac_t* mac );
-extern void  ezbus_mac_transmitter_push     ( ezbus_mac_t* mac, uint8_t level );
-extern void  ezbus_mac_transmitter_pop      ( ezbus_mac_t* mac, uint8_t level );
-extern void  ezbus_mac_transmitter_put      ( ezbus_mac_t* mac, ezbus_packet_t* packet );
+extern bool  ezbus_mac_transmitter_put      ( ezbus_mac_t* mac, ezbus_packet_t* packet );
+extern bool  ezbus_mac_transmitter_put_ref  ( ezbus_mac_t* mac, ezbus_packet_t* packet );
+extern bool  ezbus_mac_transmitter_drop     ( ezbus_mac_t* mac, ezbus_packet_t* packet );
+extern uint8_t ezbus_mac_transmitter_count  ( ezbus_mac_t* mac );
+/**
+ * @brief The bytes on the wire of the frames queued, the head included until it is popped.
+ */
+extern uint32_t ezbus_mac_transmitter_bytes ( ezbus_mac_t* mac );
 extern void  ezbus_mac_transmitter_reload   ( ezbus_mac_t* mac );
 extern void  ezbus_mac_transmitter_reset    ( ezbus_mac_t* mac );
 
@@ -64,11 +80,16 @@ extern void ezbus_mac_transmitter_signal_full         ( ezbus_mac_t* mac );
 extern void ezbus_mac_transmitter_signal_sent         ( ezbus_mac_t* mac );
 extern void ezbus_mac_transmitter_signal_wait         ( ezbus_mac_t* mac );
 extern void ezbus_mac_transmitter_signal_fault        ( ezbus_mac_t* mac );
+/**
+ * @brief The transmitter holds no more reference to the packet, or to any packet when NULL.
+ */
+extern void ezbus_mac_transmitter_signal_release      ( ezbus_mac_t* mac, ezbus_packet_t* packet );
 
 extern ezbus_packet_type_t ezbus_mac_transmitter_get_packet_type( ezbus_mac_t* mac );
 
 #define ezbus_mac_transmitter_empty(mac)      (ezbus_mac_transmitter_get_state((mac))==transmitter_state_empty)
-#define ezbus_mac_transmitter_full(mac)       (ezbus_mac_transmitter_get_state((mac))!=transmitter_state_empty)
+#define ezbus_mac_transmitter_full(mac)       (ezbus_mac_transmitter_count((mac))>=EZBUS_TRANSMIT_QUEUE)
+#define ezbus_mac_transmitter_available(mac)  (!ezbus_mac_transmitter_full((mac)))
 
 
 #ifdef __cplusplus
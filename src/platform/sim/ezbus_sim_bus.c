@@ -0,0 +1,357 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#include <ezbus_sim_bus.h>
+#include <ezbus_mac_timer.h>
+#include <ezbus_log.h>
+#include <ezbus_platform.h>
+
+#define ezbus_sim_port(port)        ((ezbus_sim_port_t*)(port)->private)
+#define ezbus_sim_wire_at(bus,n)    (&(bus)->wire[(n)%EZBUS_SIM_WIRE_LN])
+
+static int                      ezbus_sim_port_open         ( ezbus_port_t* port );
+static int                      ezbus_sim_port_send         ( ezbus_port_t* port, void* bytes, size_t size );
+static int                      ezbus_sim_port_recv         ( ezbus_port_t* port, void* bytes, size_t size );
+static void                     ezbus_sim_port_close        ( ezbus_port_t* port );
+static void                     ezbus_sim_port_flush        ( ezbus_port_t* port );
+static void                     ezbus_sim_port_drain        ( ezbus_port_t* port );
+static int                      ezbus_sim_port_getch        ( ezbus_port_t* port );
+static int                      ezbus_sim_port_set_speed    ( ezbus_port_t* port, uint32_t speed );
+static uint32_t                 ezbus_sim_port_get_speed    ( ezbus_port_t* port );
+static bool                     ezbus_sim_port_set_tx       ( ezbus_port_t* port, bool enable );
+static void                     ezbus_sim_port_set_address  ( ezbus_port_t* port, const ezbus_address_t* address );
+static const ezbus_address_t*   ezbus_sim_port_get_address  ( ezbus_port_t* port );
+
+static uint32_t                 ezbus_sim_bus_overlap       ( ezbus_sim_bus_t* bus, ezbus_sim_ns_t start );
+static ezbus_sim_ns_t           ezbus_sim_bus_next_deadline ( ezbus_sim_bus_t* bus, ezbus_t* nodes, int node_count );
+
+extern void ezbus_sim_bus_init( ezbus_sim_bus_t* bus, ezbus_sim_ns_t turnaround )
+{
+    ezbus_platform.callback_memset( bus, 0, sizeof(ezbus_sim_bus_t) );
+    bus->turnaround = turnaround;
+}
+
+extern EZBUS_ERR ezbus_sim_bus_attach( ezbus_sim_bus_t* bus, ezbus_port_t* port, uint32_t speed, const ezbus_address_t* address )
+{
+    if ( bus->port_count < EZBUS_SIM_MAX_PORTS )
+    {
+        ezbus_sim_port_t* sim_port = &bus->ports[ bus->port_count ];
+
+        ezbus_platform.callback_memset( sim_port, 0, sizeof(ezbus_sim_port_t) );
+        sim_port->bus   = bus;
+        sim_port->port  = port;
+        sim_port->index = bus->port_count++;
+        sim_port->speed = speed;
+
+        ezbus_platform.callback_memset( port, 0, sizeof(ezbus_port_t) );
+        port->private               = sim_port;
+        port->callback_open         = ezbus_sim_port_open;
+        port->callback_send         = ezbus_sim_port_send;
+        port->callback_recv         = ezbus_sim_port_recv;
+        port->callback_close        = ezbus_sim_port_close;
+        port->callback_flush        = ezbus_sim_port_flush;
+        port->callback_drain        = ezbus_sim_port_drain;
+        port->callback_getch        = ezbus_sim_port_getch;
+        port->callback_set_speed    = ezbus_sim_port_set_speed;
+        port->callback_get_speed    = ezbus_sim_port_get_speed;
+        port->callback_set_tx       = ezbus_sim_port_set_tx;
+        port->callback_set_address  = ezbus_sim_port_set_address;
+        port->callback_get_address  = ezbus_sim_port_get_address;
+
+        ezbus_sim_port_set_address( port, address );
+
+        return EZBUS_ERR_OKAY;
+    }
+    return EZBUS_ERR_LIMIT;
+}
+
+extern void ezbus_sim_bus_run( ezbus_sim_bus_t* bus, ezbus_t* nodes, int node_count )
+{
+    uint32_t head = bus->head;
+
+    for( int n=0; n < node_count; n++ )
+    {
+        ezbus_run( &nodes[n] );
+    }
+    for( int n=0; n < bus->port_count; n++ )
+    {
+        bus->ports[n].polls = 0;
+    }
+
+    if ( bus->head != head || bus->busy_until > ezbus_sim_clock_ns() )
+    {
+        bus->quiet_passes = 0;
+    }
+    else if ( ++bus->quiet_passes >= EZBUS_SIM_IDLE_PASSES )
+    {
+        bus->quiet_passes = 0;
+        if ( ezbus_sim_clock_advance_to( ezbus_sim_bus_next_deadline( bus, nodes, node_count ) ) )
+        {
+            return;
+        }
+    }
+    ezbus_sim_clock_advance_to( ezbus_sim_clock_ns() + EZBUS_SIM_PASS_NS );
+}
+
+/**
+ * @brief The earliest time at which any node must run again, see ezbus_next_wakeup().
+ */
+static ezbus_sim_ns_t ezbus_sim_bus_next_deadline( ezbus_sim_bus_t* bus, ezbus_t* nodes, int node_count )
+{
+    ezbus_ms_tick_t next = EZBUS_TIMER_FOREVER;
+
+    for( int n=0; n < node_count && next > 0; n++ )
+    {
+        ezbus_ms_tick_t expiry = ezbus_next_wakeup( &nodes[n] );
+        if ( expiry < next )
+        {
+            next = expiry;
+        }
+    }
+    if ( next == EZBUS_TIMER_FOREVER )
+    {
+        return 0;
+    }
+    return ( (ezbus_sim_ns_t)( ezbus_platform.callback_get_ms_ticks() + next ) ) * 1000000ULL;
+}
+
+extern void ezbus_sim_bus_dump( ezbus_sim_bus_t* bus, const char* prefix )
+{
+    fprintf(stderr, "%s.port_count=%d\n",       prefix, bus->port_count );
+    fprintf(stderr, "%s.tx_bytes=%llu\n",       prefix, (unsigned long long)bus->tx_bytes );
+    fprintf(stderr, "%s.collisions=%u\n",       prefix, bus->collisions );
+    fprintf(stderr, "%s.collision_bytes=%llu\n",prefix, (unsigned long long)bus->collision_bytes );
+    fprintf(stderr, "%s.busy_time=%llu\n",      prefix, (unsigned long long)bus->busy_time );
+    fflush(stderr);
+}
+
+/**
+ * @brief Locate the first wire byte still in flight at time 'start'.
+ */
+static uint32_t ezbus_sim_bus_overlap( ezbus_sim_bus_t* bus, ezbus_sim_ns_t start )
+{
+    uint32_t first = bus->head;
+    while ( first != bus->head - EZBUS_SIM_WIRE_LN && first != 0 && ezbus_sim_wire_at(bus,first-1)->time > start )
+    {
+        --first;
+    }
+    return first;
+}
+
+
+/*****************************************************************************
+* port callbacks                                                             *
+*****************************************************************************/
+
+static int ezbus_sim_port_open( ezbus_port_t* port )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    sim_port->tail = sim_port->bus->head;
+    return 0;
+}
+
+static int ezbus_sim_port_send( ezbus_port_t* port, void* bytes, size_t size )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    ezbus_sim_bus_t*  bus      = sim_port->bus;
+    ezbus_sim_ns_t    now      = ezbus_sim_clock_ns();
+    ezbus_sim_ns_t    byte_ns  = ezbus_port_byte_time_ns( port );
+    ezbus_sim_ns_t    start    = now;
+    uint8_t*          p        = (uint8_t*)bytes;
+    uint32_t          overlap;
+    uint32_t          in_flight;
+
+    /* 
+     * A driver still asserted from a previous frame may continue back-to-back,
+     * otherwise the transceiver must first be turned around.
+     */
+    if ( sim_port->tx_until >= now )
+    {
+        start = sim_port->tx_until;
+    }
+    else
+    {
+        if ( !sim_port->tx_enabled )
+        {
+            sim_port->tx_ready = now + bus->turnaround;
+        }
+        if ( sim_port->tx_ready > start )
+        {
+            start = sim_port->tx_ready;
+        }
+    }
+
+    in_flight = bus->head;
+    overlap   = ezbus_sim_bus_overlap( bus, start );
+    if ( overlap != in_flight )
+    {
+        ++bus->collisions;
+        EZBUS_LOG( EZBUS_LOG_PORT, "collision port #%d", sim_port->index );
+    }
+
+    for( size_t n=0; n < size; n++ )
+    {
+        ezbus_sim_ns_t time = start + ( byte_ns * (n+1) );
+
+        if ( overlap != in_flight )
+        {
+            /* differing bits driven against each other read back as zero */
+            ezbus_sim_wire_t* wire = ezbus_sim_wire_at( bus, overlap++ );
+            wire->byte &= p[n];
+            ++wire->drivers;
+            ++bus->collision_bytes;
+        }
+        else
+        {
+            ezbus_sim_wire_t* wire = ezbus_sim_wire_at( bus, bus->head++ );
+            wire->time    = time;
+            wire->byte    = p[n];
+            wire->drivers = 1;
+            wire->driver  = sim_port->index;
+            bus->busy_time += byte_ns;
+        }
+    }
+
+    sim_port->tx_until = start + ( byte_ns * size );
+    if ( sim_port->tx_until > bus->busy_until )
+    {
+        bus->busy_until = sim_port->tx_until;
+    }
+    bus->tx_bytes += size;
+
+    for( int n=0; n < bus->port_count; n++ )
+    {
+        if ( n != sim_port->index )
+        {
+            ezbus_port_wake( bus->ports[n].port );
+        }
+    }
+
+    return size;
+}
+
+static int ezbus_sim_port_recv( ezbus_port_t* port, void* bytes, size_t size )
+{
+    uint8_t* p = (uint8_t*)bytes;
+    int count;
+    int ch;
+
+    for( count=0; count < size && (ch = ezbus_sim_port_getch( port )) >= 0; count++ )
+    {
+        p[count] = ch;
+    }
+    return count;
+}
+
+static void ezbus_sim_port_close( ezbus_port_t* port )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    sim_port->tx_enabled = false;
+}
+
+static void ezbus_sim_port_flush( ezbus_port_t* port )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    sim_port->tail = sim_port->bus->head;
+}
+
+static void ezbus_sim_port_drain( ezbus_port_t* port )
+{
+    /* transmission is modelled, there is nothing to wait for */
+}
+
+static int ezbus_sim_port_getch( ezbus_port_t* port )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    ezbus_sim_bus_t*  bus      = sim_port->bus;
+    ezbus_sim_ns_t    now      = ezbus_sim_clock_ns();
+
+    if ( bus->head - sim_port->tail > EZBUS_SIM_WIRE_LN )
+    {
+        ++port->rx_err_overrun_count;
+        sim_port->tail = bus->head - EZBUS_SIM_WIRE_LN;
+    }
+
+    while ( sim_port->tail != bus->head )
+    {
+        ezbus_sim_wire_t* wire = ezbus_sim_wire_at( bus, sim_port->tail );
+
+        if ( wire->time > now )
+        {
+            /* virtual time skips forward to the arrival of a byte in flight */
+            if ( !ezbus_sim_clock_advance_to( wire->time ) )
+            {
+                break;
+            }
+            now = wire->time;
+        }
+
+        ++sim_port->tail;
+
+        /* the local echo of an un-collided byte is suppressed */
+        if ( wire->drivers > 1 || wire->driver != sim_port->index )
+        {
+            return wire->byte;
+        }
+    }
+
+    /* a receiver polling repeatedly within one pass is waiting, and so consumes a byte time */
+    if ( sim_port->polls++ )
+    {
+        ezbus_sim_clock_advance_to( now + ezbus_port_byte_time_ns( port ) );
+    }
+    return -1;
+}
+
+static int ezbus_sim_port_set_speed( ezbus_port_t* port, uint32_t speed )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    sim_port->speed = speed;
+    return 0;
+}
+
+static uint32_t ezbus_sim_port_get_speed( ezbus_port_t* port )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+    return sim_port->speed;
+}
+
+static bool ezbus_sim_port_set_tx( ezbus_port_t* port, bool enable )
+{
+    ezbus_sim_port_t* sim_port = ezbus_sim_port( port );
+
+    if ( enable && !sim_port->tx_enabled )
+    {
+        sim_port->tx_ready = ezbus_sim_clock_ns() + sim_port->bus->turnaround;
+    }
+    sim_port->tx_enabled = enable;
+    return true;
+}
+
+static void ezbus_sim_port_set_address( ezbus_port_t* port, const ezbus_address_t* address )
+{
+    ezbus_address_copy( &port->self_address, address );
+}
+
+static const ezbus_address_t* ezbus_sim_port_get_address( ezbus_port_t* port )
+{
+    return &port->self_address;
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#ifndef EZBUS_SIM_BUS_H_
+#define EZBUS_SIM_BUS_H_
+
+/**
+ * @page sim Simulated Bus
+ * An in-process model of a half-duplex RS-485 multi-drop segment. Any number of
+ * @ref ezbus_port_t instances may be attached to one @ref ezbus_sim_bus_t, and each
+ * may then be handed to @ref ezbus_init() as though it were a real UART port.
+ * 
+ * - Bytes occupy the wire for @ref ezbus_port_byte_time_ns() each, and become
+ *   visible to the other ports only once they have been completely shifted out.
+ * - When two ports drive the wire at the same time, the overlapping bytes are 
+ *   corrupted for every listener, and counted as a collision.
+ * - Enabling a port's driver (see callback_set_tx) costs a turnaround delay before
+ *   the first byte may be shifted out.
+ * 
+ * Under the virtual clock (see @ref sim_clock), a receiver waiting on bytes which are still
+ * in flight skips time forward to their arrival, and @ref ezbus_sim_bus_run() skips idle 
+ * stretches straight to the next timer deadline.
+ */
+
+#include <ezbus_types.h>
+#include <ezbus_port.h>
+#include <ezbus.h>
+#include <ezbus_sim_clock.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef EZBUS_SIM_WIRE_LN
+    #define EZBUS_SIM_WIRE_LN           (1024*16)   /* Wire history, bytes */
+#endif
+#ifndef EZBUS_SIM_MAX_PORTS
+    #define EZBUS_SIM_MAX_PORTS         EZBUS_MAX_PEERS
+#endif
+#ifndef EZBUS_SIM_TURNAROUND_NS
+    #define EZBUS_SIM_TURNAROUND_NS     2000        /* Driver enable turnaround */
+#endif
+#ifndef EZBUS_SIM_PASS_NS
+    #define EZBUS_SIM_PASS_NS           1000        /* Virtual host time of one pass over all nodes */
+#endif
+#ifndef EZBUS_SIM_IDLE_PASSES
+    #define EZBUS_SIM_IDLE_PASSES       8           /* Quiet passes before skipping to the next deadline */
+#endif
+
+typedef struct
+{
+    ezbus_sim_ns_t              time;               /* time at which the last bit leaves the wire */
+    uint8_t                     byte;
+    uint8_t                     drivers;            /* > 1 indicates a collision */
+    uint8_t                     driver;             /* index of the first driving port */
+} ezbus_sim_wire_t;
+
+typedef struct _ezbus_sim_port_t
+{
+    struct _ezbus_sim_bus_t*    bus;
+    ezbus_port_t*               port;
+    uint8_t                     index;
+    uint32_t                    tail;               /* wire read cursor */
+    uint32_t                    speed;
+    bool                        tx_enabled;
+    ezbus_sim_ns_t              tx_ready;           /* driver turnaround complete */
+    ezbus_sim_ns_t              tx_until;           /* end of this port's last transmission */
+    uint32_t                    polls;              /* empty polls since the last pass */
+} ezbus_sim_port_t;
+
+typedef struct _ezbus_sim_bus_t
+{
+    ezbus_sim_wire_t            wire[EZBUS_SIM_WIRE_LN];
+    uint32_t                    head;               /* total bytes ever placed on the wire */
+    ezbus_sim_ns_t              busy_until;
+    ezbus_sim_ns_t              turnaround;
+    ezbus_sim_port_t            ports[EZBUS_SIM_MAX_PORTS];
+    uint8_t                     port_count;
+    uint32_t                    quiet_passes;
+
+    uint64_t                    tx_bytes;
+    uint64_t                    collision_bytes;
+    uint32_t                    collisions;
+    ezbus_sim_ns_t              busy_time;
+} ezbus_sim_bus_t;
+
+/**
+ * @brief Prepare an empty bus with no ports attached.
+ * @param turnaround The driver enable delay in nano-seconds, ex. @ref EZBUS_SIM_TURNAROUND_NS.
+ */
+extern void             ezbus_sim_bus_init      ( ezbus_sim_bus_t* bus, ezbus_sim_ns_t turnaround );
+
+/**
+ * @brief Attach a port to the bus, and populate it's callbacks. The port must then be
+ *        opened by @ref ezbus_port_open() as usual.
+ * @param address The unique address this port is to present to the bus.
+ * @return EZBUS_ERR_OKAY, or EZBUS_ERR_LIMIT when @ref EZBUS_SIM_MAX_PORTS are attached.
+ */
+extern EZBUS_ERR        ezbus_sim_bus_attach    ( ezbus_sim_bus_t* bus, ezbus_port_t* port, uint32_t speed, const ezbus_address_t* address );
+
+/**
+ * @brief Run one pass of @ref ezbus_run() over each node, then advance the virtual clock by 
+ *        @ref EZBUS_SIM_PASS_NS, or to the next deadline once the bus has been quiet for
+ *        @ref EZBUS_SIM_IDLE_PASSES passes.
+ */
+extern void             ezbus_sim_bus_run       ( ezbus_sim_bus_t* bus, ezbus_t* nodes, int node_count );
+
+extern void             ezbus_sim_bus_dump      ( ezbus_sim_bus_t* bus, const char* prefix );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EZBUS_SIM_BUS_H_ */
@@ -0,0 +1,78 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#ifndef EZBUS_SIM_CLOCK_H_
+#define EZBUS_SIM_CLOCK_H_
+
+/**
+ * @page sim_clock Simulation Clock
+ * The time source behind ezbus_platform.callback_get_ms_ticks in the simulation platform.
+ * 
+ * - @ref ezbus_sim_clock_wall follows CLOCK_MONOTONIC, the bus runs in real time.
+ * - @ref ezbus_sim_clock_virtual is a discrete-event clock which only moves when it is
+ *   advanced, see @ref ezbus_sim_clock_advance_to(). Together with a fixed random seed, 
+ *   every run of a scenario produces identical results, at whatever pace the host allows.
+ */
+
+#include <ezbus_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint64_t ezbus_sim_ns_t;
+
+typedef enum
+{
+    ezbus_sim_clock_wall=0,
+    ezbus_sim_clock_virtual
+} ezbus_sim_clock_source_t;
+
+/**
+ * @brief Select the time source, must be invoked prior to @ref ezbus_platform_setup().
+ *        Selecting @ref ezbus_sim_clock_virtual resets virtual time to zero.
+ */
+extern void                     ezbus_sim_clock_set_source  ( ezbus_sim_clock_source_t source );
+extern ezbus_sim_clock_source_t ezbus_sim_clock_get_source  ( void );
+
+/**
+ * @brief The current simulation time in nano-seconds.
+ */
+extern ezbus_sim_ns_t           ezbus_sim_clock_ns          ( void );
+
+/**
+ * @brief Move virtual time forward to 'ns'. Has no effect on the wall clock, or when 'ns' is 
+ *        not in the future.
+ * @return true if time was advanced.
+ */
+extern bool                     ezbus_sim_clock_advance_to  ( ezbus_sim_ns_t ns );
+
+/**
+ * @brief Set the seed used by callback_rand_init, must be invoked prior to @ref ezbus_platform_setup().
+ *        When no seed is given, the virtual clock uses a fixed seed, and the wall clock seeds from time.
+ */
+extern void                     ezbus_sim_clock_set_seed    ( unsigned int seed );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EZBUS_SIM_CLOCK_H_ */
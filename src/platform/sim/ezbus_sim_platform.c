@@ -0,0 +1,138 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#include <ezbus_platform.h>
+#include <ezbus_sim_clock.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+static int              ezbus_sim_random        ( int lower, int upper );
+static void             ezbus_sim_rand_init     ( void );
+static void             ezbus_sim_delay         ( unsigned int ms );
+static ezbus_ms_tick_t  ezbus_sim_get_ms_ticks  ( void );
+
+#define EZBUS_SIM_SEED_DEF      1
+
+static ezbus_sim_clock_source_t clock_source = ezbus_sim_clock_wall;
+static ezbus_sim_ns_t           clock_virtual_ns = 0;
+static bool                     clock_seeded = false;
+static unsigned int             clock_seed = EZBUS_SIM_SEED_DEF;
+
+ezbus_platform_t ezbus_platform =
+{
+    .cmdline                = NULL,
+    .callback_memset        = memset,
+    .callback_memcpy        = memcpy,
+    .callback_memmove       = memmove,
+    .callback_memcmp        = memcmp,
+    .callback_strcpy        = strcpy,
+    .callback_strcat        = strcat,
+    .callback_strncpy       = strncpy,
+    .callback_strcmp        = strcmp,
+    .callback_strcasecmp    = strcasecmp,
+    .callback_strlen        = strlen,
+    .callback_malloc        = malloc,
+    .callback_realloc       = realloc,
+    .callback_free          = free,
+    .callback_rand          = rand,
+    .callback_srand         = srand,
+    .callback_random        = ezbus_sim_random,
+    .callback_rand_init     = ezbus_sim_rand_init,
+    .callback_delay         = ezbus_sim_delay,
+    .callback_get_ms_ticks  = ezbus_sim_get_ms_ticks,
+};
+
+extern int ezbus_platform_setup( void* cmdline_obj )
+{
+    ezbus_platform.cmdline = cmdline_obj;
+    ezbus_platform.callback_rand_init();
+    return 0;
+}
+
+extern void ezbus_sim_clock_set_source( ezbus_sim_clock_source_t source )
+{
+    clock_source = source;
+    clock_virtual_ns = 0;
+}
+
+extern ezbus_sim_clock_source_t ezbus_sim_clock_get_source( void )
+{
+    return clock_source;
+}
+
+extern ezbus_sim_ns_t ezbus_sim_clock_ns( void )
+{
+    if ( clock_source == ezbus_sim_clock_virtual )
+    {
+        return clock_virtual_ns;
+    }
+    else
+    {
+        struct timespec ts;
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return ( (ezbus_sim_ns_t)ts.tv_sec * 1000000000ULL ) + (ezbus_sim_ns_t)ts.tv_nsec;
+    }
+}
+
+extern bool ezbus_sim_clock_advance_to( ezbus_sim_ns_t ns )
+{
+    if ( clock_source == ezbus_sim_clock_virtual && ns > clock_virtual_ns )
+    {
+        clock_virtual_ns = ns;
+        return true;
+    }
+    return false;
+}
+
+extern void ezbus_sim_clock_set_seed( unsigned int seed )
+{
+    clock_seed = seed;
+    clock_seeded = true;
+}
+
+static ezbus_ms_tick_t ezbus_sim_get_ms_ticks( void )
+{
+    return (ezbus_ms_tick_t)( ezbus_sim_clock_ns() / 1000000ULL );
+}
+
+static int ezbus_sim_random( int lower, int upper )
+{
+    return ( rand() % ( upper - lower + 1 ) ) + lower;
+}
+
+static void ezbus_sim_rand_init( void )
+{
+    if ( clock_seeded || clock_source == ezbus_sim_clock_virtual )
+        srand( clock_seed );
+    else
+        srand( (unsigned int)ezbus_sim_clock_ns() );
+}
+
+static void ezbus_sim_delay( unsigned int ms )
+{
+    ezbus_ms_tick_t start = ezbus_sim_get_ms_ticks();
+    if ( !ezbus_sim_clock_advance_to( ezbus_sim_clock_ns() + ( (ezbus_sim_ns_t)ms * 1000000ULL ) ) )
+    {
+        while ( ( ezbus_sim_get_ms_ticks() - start ) < ms );
+    }
+}
@@ -30,55 +30,92 @@
 #include <ezbus_log.h>
 #include <ezbus_platform.h>
 
-ezbus_socket_state_t ezbus_sockets[ EZBUS_MAX_SOCKETS ];
+static ezbus_socket_t   ezbus_socket_slot_available ( ezbus_mac_t* mac );
+static void             ezbus_socket_slot_clear     ( ezbus_mac_t* mac, size_t index );
+static ezbus_packet_t*  ezbus_socket_tx_slot        ( ezbus_mac_t* mac, ezbus_socket_t socket );
+static void             ezbus_socket_prepare_data_header ( ezbus_mac_t* mac, ezbus_socket_t socket, ezbus_packet_t* tx_packet, ezbus_address_t* dst_address, ezbus_socket_t dst_socket, uint16_t chain );
+static size_t           ezbus_socket_prepare_data_packet ( ezbus_mac_t* mac, ezbus_socket_t socket, ezbus_packet_t* tx_packet, ezbus_address_t* dst_address, ezbus_socket_t dst_socket, uint8_t* data, size_t size, uint16_t chain );
+static EZBUS_ERR        ezbus_socket_prepare_close_packet ( ezbus_mac_t* mac, ezbus_socket_t socket, ezbus_packet_t* tx_packet, ezbus_address_t* dst_address, ezbus_socket_t dst_socket );
 
-static size_t           socket_count = 0;
 
-static ezbus_socket_t   ezbus_socket_slot_available ( void );
-static void             ezbus_socket_slot_clear     ( size_t index );
-static size_t           ezbus_socket_count          ( void );
-static size_t           ezbus_socket_prepare_data_packet ( ezbus_socket_t socket, ezbus_address_t* dst_address, ezbus_socket_t dst_socket, uint8_t* data, size_t size );
-static EZBUS_ERR        ezbus_socket_prepare_close_packet ( ezbus_socket_t socket, ezbus_address_t* dst_address, ezbus_socket_t dst_socket );
-
-
-extern void ezbus_socket_init( void )
+extern void ezbus_socket_init ( 
+                                ezbus_mac_t*                    mac,
+                                ezbus_socket_callback_send_t    callback_send,
+                                ezbus_socket_callback_recv_t    callback_recv,
+                                ezbus_socket_callback_closing_t callback_closing,
+                                void*                           arg
+                              )
 {
-    ezbus_platform.callback_memset( ezbus_sockets, 0, sizeof(ezbus_socket_state_t*) * ezbus_socket_get_max() );
-    socket_count=0;
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    ezbus_platform.callback_memset( table, 0, sizeof(ezbus_socket_table_t) );
+    table->callback_send    = callback_send;
+    table->callback_recv    = callback_recv;
+    table->callback_closing = callback_closing;
+    table->callback_arg     = arg;
+    ezbus_pool_init( &table->pool, table->blocks, sizeof(ezbus_packet_t), EZBUS_POOL_BLOCKS );
 }
 
 extern ezbus_socket_t ezbus_socket_open( ezbus_mac_t* mac, ezbus_address_t* peer_address, ezbus_socket_t peer_socket )
 {
-    ezbus_socket_t socket = ezbus_socket_slot_available();
+    ezbus_socket_t socket = ezbus_socket_slot_available( mac );
     if ( socket != EZBUS_SOCKET_INVALID )
     {
-        ezbus_socket_state_t* socket_state = &ezbus_sockets[socket];
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         ezbus_platform.callback_memset( socket_state, 0, sizeof(ezbus_socket_state_t) );
         socket_state->mac = mac;
-        ezbus_packet_set_src( &socket_state->rx_packet, peer_address );
-        ezbus_packet_set_src_socket( &socket_state->rx_packet, peer_socket );
-        ++socket_count;
+        socket_state->tx_window_size = EZBUS_SOCKET_WINDOW;
+        socket_state->tx_ack_tries = EZBUS_RETRANSMIT_TRIES;
+        ezbus_address_copy( &socket_state->peer_address, peer_address );
+        socket_state->peer_socket = peer_socket;
+        ++ezbus_mac_get_sockets( mac )->count;
         EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d", socket );
     }
     return socket;
 }
 
-extern void ezbus_socket_close( ezbus_socket_t socket )
+extern void ezbus_socket_close( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ezbus_socket_is_open( socket ) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
+        ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d", socket );
-        if ( ezbus_socket_get_peer_socket( socket ) != EZBUS_SOCKET_INVALID )
+
+        /* the window is about to be cleared, withdraw whatever of it is still queued */
+        for( uint8_t slot=0; slot < EZBUS_SOCKET_WINDOW; slot++ )
+        {
+            if ( socket_state->tx_window[ slot ] != NULL )
+            {
+                if ( ezbus_mac_transmitter_drop( mac, socket_state->tx_window[ slot ] ) )
+                {
+                    ezbus_pool_free( ezbus_socket_get_pool( mac ), socket_state->tx_window[ slot ] );
+                }
+                else
+                {
+                    /* on its way out on the wire, it goes back to the pool once the transmitter lets go */
+                    table->tx_orphan = socket_state->tx_window[ slot ];
+                }
+            }
+        }
+        while ( socket_state->rx_queue_tail != socket_state->rx_queue_head )
         {
+            ezbus_socket_rx_pop( mac, socket );
+        }
+
+        if ( ezbus_socket_get_peer_socket( mac, socket ) != EZBUS_SOCKET_INVALID )
+        {
+            ezbus_packet_control_t tx_control;
+            ezbus_packet_t* tx_packet = ezbus_packet_control( &tx_control );
             EZBUS_ERR err = ezbus_socket_prepare_close_packet(  
+                                                                mac,
                                                                 socket, 
-                                                                ezbus_socket_get_peer_address( socket ),
-                                                                ezbus_socket_get_peer_socket( socket )
+                                                                tx_packet,
+                                                                ezbus_socket_get_peer_address( mac, socket ),
+                                                                ezbus_socket_get_peer_socket( mac, socket )
                                                             );
             if ( err == EZBUS_ERR_OKAY )
             {
-                ezbus_mac_t* mac = ezbus_socket_get_mac( socket );
-                ezbus_mac_transmitter_put( mac, ezbus_socket_get_tx_packet( socket ) );
+                ezbus_mac_transmitter_put( mac, tx_packet );
             }
             else
             {
@@ -89,62 +126,152 @@ extern void ezbus_socket_close( ezbus_socket_t socket )
         {
             EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d peer == EZBUS_SOCKET_INVALID", socket );
         }
-        ezbus_socket_callback_closing( socket );
-        ezbus_socket_slot_clear( socket );
-        --socket_count;
+        if ( table->callback_closing != NULL )
+        {
+            table->callback_closing( mac, socket, table->callback_arg );
+        }
+        ezbus_socket_slot_clear( mac, socket );
+        --table->count;
     }
 }
 
-extern bool ezbus_socket_is_open( ezbus_socket_t socket )
+extern bool ezbus_socket_is_open( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    return ( ezbus_socket_get_mac( socket ) != NULL );
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    return ( socket_state != NULL && socket_state->mac != NULL );
 }
 
 
-extern int ezbus_socket_send( ezbus_socket_t socket, void* data, size_t size )
+extern int ezbus_socket_send( ezbus_mac_t* mac, ezbus_socket_t socket, void* data, size_t size )
 {
-    ezbus_mac_t* mac = ezbus_socket_get_mac( socket );
-
-    if ( mac != NULL )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        size_t parcel_data_size = ezbus_socket_prepare_data_packet   (  
-                                                                    socket, 
-                                                                    ezbus_socket_get_peer_address( socket ),
-                                                                    ezbus_socket_get_peer_socket( socket ),
-                                                                    data,
-                                                                    size
-                                                                );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        ezbus_packet_t* tx_packet;
+        uint8_t* bytes = (uint8_t*)data;
+        size_t sent = 0;
+
+        /* segment into as many chained parcels as the window has room for */
+        do
+        {
+            if ( ( tx_packet = ezbus_socket_tx_slot( mac, socket ) ) == NULL )
+            {
+                break;
+            }
 
-        ezbus_mac_transmitter_put( mac, ezbus_socket_get_tx_packet( socket ) );
+            bool     begin = !socket_state->tx_chained;
+            bool     last  = ( size - sent ) <= EZBUS_PARCEL_DATA_LN;
+            uint16_t chain = begin ? ( last ? PACKET_BITS_CHAIN_SINGLE : PACKET_BITS_CHAIN_BEGIN ) 
+                                   : ( last ? PACKET_BITS_CHAIN_LAST   : PACKET_BITS_CHAIN_MIDDLE );
 
-        return parcel_data_size;
+            sent += ezbus_socket_prepare_data_packet (  
+                                                        mac,
+                                                        socket, 
+                                                        tx_packet,
+                                                        ezbus_socket_get_peer_address( mac, socket ),
+                                                        ezbus_socket_get_peer_socket( mac, socket ),
+                                                        &bytes[sent],
+                                                        size - sent,
+                                                        chain
+                                                    );
+            ezbus_socket_set_tx_seq( mac, socket, ezbus_socket_get_tx_seq( mac, socket ) + 1 );
+            socket_state->tx_chained = !last;
+        } while ( sent < size );
+
+        /* the rest of the window follows as the transmitter empties */
+        ezbus_socket_transmit_next( mac, socket );
+
+        return sent;
     }
-    EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d mac == NULL", socket );
-    ezbus_socket_set_err( socket, EZBUS_ERR_NOTREADY );
+    EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d not open", socket );
+    ezbus_socket_set_err( mac, socket, EZBUS_ERR_NOTREADY );
     return -1;
 }
 
-extern int ezbus_socket_recv( ezbus_socket_t socket, void* data, size_t size )
+extern void* ezbus_socket_reserve( ezbus_mac_t* mac, ezbus_socket_t socket, size_t* size )
 {
-    if ( ezbus_socket_is_open( socket ) )
-    {    
-        ezbus_packet_t* rx_packet = ezbus_socket_get_rx_packet( socket );
-        ezbus_parcel_t* rx_parcel = ezbus_packet_get_parcel( rx_packet );
-        size_t read_data_size = ( size > ezbus_parcel_get_size( rx_parcel ) ) ? ezbus_parcel_get_size( rx_parcel ) : size;
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        ezbus_packet_t* tx_packet;
 
-        ezbus_platform.callback_memcpy( data, ezbus_parcel_get_ptr( rx_parcel ), read_data_size );
+        /* a chain still in progress must be finished by ezbus_socket_send() */
+        if ( !socket_state->tx_chained && ( tx_packet = ezbus_socket_tx_slot( mac, socket ) ) != NULL )
+        {
+            ezbus_parcel_t* tx_parcel = ezbus_packet_get_parcel( tx_packet );
 
-        if ( read_data_size < ezbus_parcel_get_size( rx_parcel ) )
+            /* the header goes first, ezbus_packet_init() clears the start of the attachment */
+            ezbus_socket_prepare_data_header (  
+                                                mac,
+                                                socket, 
+                                                tx_packet,
+                                                ezbus_socket_get_peer_address( mac, socket ),
+                                                ezbus_socket_get_peer_socket( mac, socket ),
+                                                PACKET_BITS_CHAIN_SINGLE
+                                            );
+            if ( size != NULL )
+            {
+                *size = ezbus_parcel_get_max( tx_parcel );
+            }
+            return ezbus_parcel_get_ptr( tx_parcel );
+        }
+        return NULL;
+    }
+    EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d not open", socket );
+    ezbus_socket_set_err( mac, socket, EZBUS_ERR_NOTREADY );
+    return NULL;
+}
+
+extern int ezbus_socket_commit( ezbus_mac_t* mac, ezbus_socket_t socket, size_t size )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        ezbus_packet_t* tx_packet;
+
+        if ( size > EZBUS_PARCEL_DATA_LN )
+        {
+            ezbus_socket_set_err( mac, socket, EZBUS_ERR_RANGE );
+            return -1;
+        }
+        if ( socket_state->tx_chained || ( tx_packet = ezbus_socket_tx_slot( mac, socket ) ) == NULL )
         {
-            // shrink parcel data...
-            uint8_t* parcel_data = (uint8_t*)ezbus_parcel_get_ptr( rx_parcel );
-            ezbus_platform.callback_memmove  ( 
-                                        parcel_data, 
-                                        &parcel_data[read_data_size],
-                                        ezbus_parcel_get_size( rx_parcel )-read_data_size 
-                                    );
-            ezbus_parcel_set_size( rx_parcel,  ezbus_parcel_get_size( rx_parcel )-read_data_size );
+            return 0;
         }
+
+        /* header and payload are already in place, only the size is written */
+        ezbus_parcel_set_size( ezbus_packet_get_parcel( tx_packet ), size );
+        ezbus_socket_set_tx_seq( mac, socket, ezbus_socket_get_tx_seq( mac, socket ) + 1 );
+
+        ezbus_socket_transmit_next( mac, socket );
+
+        return size;
+    }
+    EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d not open", socket );
+    ezbus_socket_set_err( mac, socket, EZBUS_ERR_NOTREADY );
+    return -1;
+}
+
+extern int ezbus_socket_recv( ezbus_mac_t* mac, ezbus_socket_t socket, void* data, size_t size )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {    
+        size_t read_data_size = 0;
+        size_t borrowed;
+        const void* bytes;
+
+        /* a read of a chained message takes a borrow per parcel */
+        do
+        {
+            bytes = ezbus_socket_borrow( mac, socket, &borrowed );
+            borrowed = ( borrowed > size - read_data_size ) ? size - read_data_size : borrowed;
+            if ( bytes != NULL )
+            {
+                ezbus_platform.callback_memcpy( (uint8_t*)data + read_data_size, bytes, borrowed );
+            }
+            ezbus_socket_release( mac, socket, borrowed );
+            read_data_size += borrowed;
+        } while ( borrowed && read_data_size < size && ezbus_socket_get_rx_size( mac, socket ) && !ezbus_socket_recv_end( mac, socket ) );
         
         return read_data_size;
     }
@@ -156,32 +283,159 @@ extern int ezbus_socket_recv( ezbus_socket_t socket, void* data, size_t size )
     return 0;
 }
 
+extern const void* ezbus_socket_borrow( ezbus_mac_t* mac, ezbus_socket_t socket, size_t* size )
+{
+    size_t rx_size = 0;
+    const void* bytes = NULL;
+
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {    
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+
+        if ( socket_state->rx_lent != NULL )
+        {
+            rx_size = socket_state->rx_lent_size;
+            bytes   = socket_state->rx_lent;
+        }
+        else if ( socket_state->rx_queue_tail != socket_state->rx_queue_head )
+        {
+            ezbus_parcel_t* rx_parcel = ezbus_packet_get_parcel( socket_state->rx_queue[ socket_state->rx_queue_tail % EZBUS_SOCKET_RX_PARCELS ] );
+            rx_size = ezbus_parcel_get_size( rx_parcel ) - socket_state->rx_offset;
+            bytes   = (uint8_t*)ezbus_parcel_get_ptr( rx_parcel ) + socket_state->rx_offset;
+        }
+    }
+    if ( size != NULL )
+    {
+        *size = rx_size;
+    }
+    return bytes;
+}
+
+extern void ezbus_socket_release( ezbus_mac_t* mac, ezbus_socket_t socket, size_t size )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {    
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+
+        if ( socket_state->rx_lent != NULL )
+        {
+            size = ( size > socket_state->rx_lent_size ) ? socket_state->rx_lent_size : size;
+            socket_state->rx_lent      += size;
+            socket_state->rx_lent_size -= size;
+
+            // reached the end of a message?
+            if ( socket_state->rx_lent_size == 0 && socket_state->rx_lent_end )
+            {
+                socket_state->rx_lent_end    = false;
+                socket_state->rx_message_end = true;
+            }
+            else if ( size )
+            {
+                socket_state->rx_message_end = false;
+            }
+        }
+        else if ( socket_state->rx_queue_tail != socket_state->rx_queue_head )
+        {
+            ezbus_packet_t* rx_block = socket_state->rx_queue[ socket_state->rx_queue_tail % EZBUS_SOCKET_RX_PARCELS ];
+            size_t rx_size = ezbus_parcel_get_size( ezbus_packet_get_parcel( rx_block ) ) - socket_state->rx_offset;
+
+            size = ( size > rx_size ) ? rx_size : size;
+            socket_state->rx_offset += size;
+
+            // reached the end of a message?
+            if ( size == rx_size && ezbus_packet_chain( rx_block ) == PACKET_BITS_CHAIN_LAST )
+            {
+                socket_state->rx_message_end = true;
+            }
+            else if ( size )
+            {
+                socket_state->rx_message_end = false;
+            }
+            if ( size == rx_size )
+            {
+                /* all read, the block goes back to the pool */
+                ezbus_socket_rx_pop( mac, socket );
+            }
+        }
+    }
+}
+
+extern bool ezbus_socket_recv_end( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return socket_state->rx_message_end;
+    }
+    return false;
+}
+
+/**
+ * @brief The window slot for the next sequence number, provided the window has room, and either
+ *        a block could be drawn from the pool, or the transmitter has let go of what it last held.
+ */
+static ezbus_packet_t* ezbus_socket_tx_slot( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    ezbus_packet_t** slot = &socket_state->tx_window[ ezbus_socket_get_tx_seq( mac, socket ) % EZBUS_SOCKET_WINDOW ];
+
+    if ( ezbus_socket_get_tx_pending( mac, socket ) >= ezbus_socket_get_tx_window_size( mac, socket ) )
+    {
+        /* window is full, wait for the peer to acknowledge */
+        return NULL;
+    }
+    if ( *slot == NULL )
+    {
+        /* NULL when the pool is exhausted, the consumer tries again on a later send callback */
+        *slot = (ezbus_packet_t*)ezbus_pool_alloc( ezbus_socket_get_pool( mac ) );
+    }
+    else if ( !ezbus_mac_transmitter_drop( mac, *slot ) )
+    {
+        /* an earlier use of the slot is still going out on the wire */
+        return NULL;
+    }
+    return *slot;
+}
+
+static void ezbus_socket_prepare_data_header ( 
+                                                ezbus_mac_t*     mac,
+                                                ezbus_socket_t   socket, 
+                                                ezbus_packet_t*  tx_packet,
+                                                ezbus_address_t* dst_address, 
+                                                ezbus_socket_t   dst_socket, 
+                                                uint16_t         chain
+                                            )
+{
+    ezbus_packet_init           ( tx_packet );
+    ezbus_packet_set_type       ( tx_packet, packet_type_parcel );
+    ezbus_packet_set_seq        ( tx_packet, ezbus_socket_get_tx_seq( mac, socket ) );
+    ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
+    ezbus_packet_set_src_socket ( tx_packet, socket );
+    ezbus_packet_set_dst        ( tx_packet, dst_address );
+    ezbus_packet_set_dst_socket ( tx_packet, dst_socket );
+    ezbus_packet_set_chain      ( tx_packet, chain );
+    ezbus_packet_set_urgent     ( tx_packet, ezbus_socket_get_urgent( mac, socket ) ? PACKET_BITS_URGENT : 0 );
+
+    EZBUS_LOG( EZBUS_LOG_SOCKET, "src:self:%d dst:%s:%d", socket, ezbus_address_string( dst_address), dst_socket );
+}
+
 static size_t ezbus_socket_prepare_data_packet   ( 
+                                                ezbus_mac_t*     mac,
                                                 ezbus_socket_t   socket, 
+                                                ezbus_packet_t*  tx_packet,
                                                 ezbus_address_t* dst_address, 
                                                 ezbus_socket_t   dst_socket, 
                                                 uint8_t*         data, 
-                                                size_t           size 
+                                                size_t           size,
+                                                uint16_t         chain
                                             )
 {
-    if ( ezbus_socket_is_open( socket ) && dst_address != NULL )
+    if ( ezbus_socket_is_open( mac, socket ) && dst_address != NULL )
     {
         size_t parcel_data_size = ( size > EZBUS_PARCEL_DATA_LN ) ? EZBUS_PARCEL_DATA_LN : size;
-        ezbus_packet_t* tx_packet = ezbus_socket_get_tx_packet  ( socket );
-        ezbus_parcel_t* tx_parcel = ezbus_packet_get_parcel ( tx_packet );
-
-        ezbus_packet_init           ( tx_packet );
-        ezbus_packet_set_type       ( tx_packet, packet_type_parcel );
-        ezbus_packet_set_seq        ( tx_packet, ezbus_socket_get_tx_seq( socket ) );
-        ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_socket_get_port(socket)) );
-        ezbus_packet_set_src_socket ( tx_packet, socket );
-        ezbus_packet_set_dst        ( tx_packet, dst_address );
-        ezbus_packet_set_dst_socket ( tx_packet, dst_socket );
 
-        ezbus_parcel_init           ( tx_parcel );
-        ezbus_parcel_set_data       ( tx_parcel, data, parcel_data_size );
-
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "src:self:%d dst:%s:%d", socket, ezbus_address_string( dst_address), dst_socket );
+        ezbus_socket_prepare_data_header ( mac, socket, tx_packet, dst_address, dst_socket, chain );
+        ezbus_parcel_set_data            ( ezbus_packet_get_parcel ( tx_packet ), data, parcel_data_size );
 
         return parcel_data_size;
     }
@@ -190,40 +444,37 @@ static size_t ezbus_socket_prepare_data_packet   (
 
 
 static EZBUS_ERR ezbus_socket_prepare_close_packet   ( 
+                                                ezbus_mac_t*     mac,
                                                 ezbus_socket_t   socket, 
+                                                ezbus_packet_t*  tx_packet,
                                                 ezbus_address_t* dst_address, 
                                                 ezbus_socket_t   dst_socket
                                             )
 {
-    if ( ezbus_socket_is_open( socket ) && dst_address != NULL )
+    if ( ezbus_socket_is_open( mac, socket ) && dst_address != NULL )
     {
-        ezbus_packet_t* tx_packet = ezbus_socket_get_tx_packet  ( socket );
-        ezbus_parcel_t* tx_parcel = ezbus_packet_get_parcel ( tx_packet );
-
         ezbus_packet_init           ( tx_packet );
         ezbus_packet_set_type       ( tx_packet, packet_type_parcel );
-        ezbus_packet_set_seq        ( tx_packet, ezbus_socket_get_tx_seq( socket ) );
-        ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_socket_get_port(socket)) );
+        ezbus_packet_set_seq        ( tx_packet, ezbus_socket_get_tx_seq( mac, socket ) );
+        ezbus_packet_set_src        ( tx_packet, ezbus_port_get_address(ezbus_mac_get_port(mac)) );
         ezbus_packet_set_src_socket ( tx_packet, EZBUS_SOCKET_INVALID );
         ezbus_packet_set_dst        ( tx_packet, dst_address );
         ezbus_packet_set_dst_socket ( tx_packet, dst_socket );
 
         EZBUS_LOG( EZBUS_LOG_SOCKET, "src:self:%d dst:%s:%d", socket, ezbus_address_string( dst_address ), dst_socket );
 
-        ezbus_parcel_init           ( tx_parcel );
-
         return EZBUS_ERR_OKAY;
     }
     return EZBUS_ERR_IO;
 }
 
-static ezbus_socket_t ezbus_socket_slot_available( void )
+static ezbus_socket_t ezbus_socket_slot_available( ezbus_mac_t* mac )
 {
-    if ( ezbus_socket_count() < ezbus_socket_get_max() )
+    if ( ezbus_socket_get_count( mac ) < ezbus_socket_get_max() )
     {
         for( ezbus_socket_t n=0; n < ezbus_socket_get_max(); n++ )
         {
-            if ( ezbus_socket_get_mac( n ) == NULL )
+            if ( !ezbus_socket_is_open( mac, n ) )
             {
                 return n;
             } 
@@ -232,13 +483,7 @@ static ezbus_socket_t ezbus_socket_slot_available( void )
     return EZBUS_SOCKET_INVALID;
 }
 
-static void ezbus_socket_slot_clear( size_t index )
+static void ezbus_socket_slot_clear( ezbus_mac_t* mac, size_t index )
 {
-    ezbus_platform.callback_memset(&ezbus_sockets[ index ], 0, sizeof(ezbus_socket_state_t) );
+    ezbus_platform.callback_memset( ezbus_socket_get_at( mac, index ), 0, sizeof(ezbus_socket_state_t) );
 }
-
-static size_t ezbus_socket_count( void )
-{
-    return socket_count;
-}
-
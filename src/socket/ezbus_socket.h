@@ -30,10 +30,10 @@
  * single peer. A `socket` must be 'opened' before it can be used. See @ref ezbus_socket_open()
  * for more details. 
  * In the case that an unsolicited parcel packet arrives from a peer (socket==EXBUS_SICKET_ANY), 
- * a local `socket` will automatically be opened prior to @ref ezbus_socket_callback_recv() 
+ * a local `socket` will automatically be opened prior to the receive callback 
  * being invoked. The socket remain opened until closed by the consumer of this API.
- * Be sure to review @ref ezbus_socket_init(), @ref ezbus_socket_callback_send() and 
- * @ref ezbus_socket_callback_recv()
+ * Sockets are numbered per mac, every socket function takes the mac the socket belongs to.
+ * Be sure to review @ref ezbus_socket_init()
  */
 
 #include <ezbus_packet.h>
@@ -46,30 +46,25 @@ extern "C" {
 #endif
 
 /**
- * @brief The consumer of this API is required to implement @ref ezbus_socket_callback_send(),
- *          see @ref ezbus_socket_send() for details.
- * @param socket The socket available to send on, or EZBUS_SOCKET_ANY indicates transmitter is
+ * @brief Initializes the socket layer of a mac, and must be invoked once, after @ref ezbus_init(),
+ *          prior to using any socket functions on that mac. Each mac owns its own table of
+ *          @ref EZBUS_MAX_SOCKETS sockets, so any number of buses may run side by side.
+ *          Invocation must take place from with the thread context of the consumer of the API.
+ * @param mac The MAC interface instance whose sockets are to be served.
+ * @param callback_send Invoked when the transmitter may accept data, see @ref ezbus_socket_send().
+ *          The socket is available to send on, or EZBUS_SOCKET_ANY indicates the transmitter is
  *          empty, meaning that any write to the ezbus transmitter buffer is okay.
+ * @param callback_recv Invoked when a parcel has arrived, see @ref ezbus_socket_recv().
+ * @param callback_closing Invoked as a socket is closed, see @ref ezbus_socket_close().
+ * @param arg Passed unaltered to each callback.
  */
-extern bool ezbus_socket_callback_send ( ezbus_socket_t socket );
-
-/**
- * @brief The consumer of this API is required to implement @ref ezbus_socket_callback_recv(), 
- *          see @ref ezbus_socket_recv() for details.
- */
-extern bool ezbus_socket_callback_recv ( ezbus_socket_t socket );
-
-/**
- * @brief The consumer of this API is required to implement @ref ezbus_socket_callback_closing(), 
- *          see @ref ezbus_socket_close() for details.
- */
-extern void ezbus_socket_callback_closing ( ezbus_socket_t socket );
-
-/**
- * @brief Initializes the socket layer, and must be invoked once prior to using any socket functions
- *          Invocation must take place from with the thre ad context of the consumer of the API.
- */
-extern void ezbus_socket_init ( void );
+extern void ezbus_socket_init ( 
+                                ezbus_mac_t*                    mac,
+                                ezbus_socket_callback_send_t    callback_send,
+                                ezbus_socket_callback_recv_t    callback_recv,
+                                ezbus_socket_callback_closing_t callback_closing,
+                                void*                           arg
+                              );
 
 
 /** 
@@ -79,33 +74,91 @@ extern void ezbus_socket_init ( void );
  *          @ref ezbus_tranceiver_callback_send(), the consumer signals the desire to have the packet transmitted,
  *          otherwise the prepared parcel packet will remain dormant until such time that 'true' is
  *          returned by @ref ezbus_tranceiver_callback_send().
+ * @param mac The MAC interface instance the socket belongs to.
  * @param socket Integer value that references the given socket connection, @ref ezbus_socket_open()
  * @param data Pointer to the data bytes to transmit. May be of arbitrary length, however, all of the 
  *          data bytes may not be transmitted, see return value for usage suggestion.
+ *          Messages larger than @ref EZBUS_PARCEL_DATA_LN are segmented into a chain of parcels 
+ *          and reassembled by the receiving socket. A chain continues until its last parcel has been 
+ *          accepted, so after a partial send, the next send on the socket must pass the remaining bytes.
  * @param size Represents the total nbumber of bytes to send.
  * @return The number of bytes sent. If return is < `size` and > 0 tis indicates that the transmission
  *          was successful, however not all bytes where transmitted. In this case, the consumer
  *          may choose to use the return value to continue to transmit the remaining bytes.
  *          If 0 is returned, then the socket was unable to transmit the bytes at this time (be sure
  *          to synchronize @ref ezbus_tranceiver_send() with ezbus_tranceiver_callback_send() to ensure
- *          that it is an appropriate time to populate a transmitter packet. If -1 is returned, then
+ *          that it is an appropriate time to populate a transmitter packet), or that the socket
+ *          already has @ref ezbus_socket_get_tx_window_size() parcels awaiting acknowledgement
+ *          from the peer (see @ref EZBUS_SOCKET_WINDOW). If -1 is returned, then
  *          a fault has occured, and @ezbus_socket_err() will return the nature of the failure.
  */
-extern int ezbus_socket_send ( ezbus_socket_t socket, void* data, size_t size );
+extern int ezbus_socket_send ( ezbus_mac_t* mac, ezbus_socket_t socket, void* data, size_t size );
+
+/**
+ * @brief Zero-copy alternative to @ref ezbus_socket_send() for messages that fit one parcel.
+ *          Returns a pointer straight into the next parcel of the socket's transmit window, for
+ *          the consumer to fill, and then pass to @ref ezbus_socket_commit(). The parcel is sent
+ *          from where it lies, so the payload is never copied again on its way to the port.
+ * @param mac The MAC interface instance the socket belongs to.
+ * @param socket Integer value that references the given socket connection, @ref ezbus_socket_open()
+ * @param size If not NULL, receives the room available, @ref EZBUS_PARCEL_DATA_LN bytes.
+ * @return Pointer to the parcel data, or NULL when the window is full, a chained message sent
+ *          by @ref ezbus_socket_send() is still in progress, or the socket is not open.
+ */
+extern void* ezbus_socket_reserve ( ezbus_mac_t* mac, ezbus_socket_t socket, size_t* size );
+
+/**
+ * @brief Queue the parcel filled in after @ref ezbus_socket_reserve() as a single parcel message.
+ * @param size The number of bytes written, at most the room returned by @ref ezbus_socket_reserve().
+ * @return `size` once queued, 0 if the window has no room, or -1 on a fault, see @ref ezbus_socket_get_err().
+ */
+extern int ezbus_socket_commit ( ezbus_mac_t* mac, ezbus_socket_t socket, size_t size );
 
 /**
  * @brief @ref ezbus_socket_recv() must be sync'ed with @ref ezbus_tranceiver_callback_recv() 
  *          When @ref ezbus_tranceiver_callback_recv() is invoked, and the consumer wishes to receive
  *          the data, then the consumer should invoke @ref ezbus_socket_recv() to extract the packet
  *          parcel data. Returning `true` will initiate an `ack` response to the received parcel packet.
- *          otherwise a `nack` response.
+ *          otherwise a `nack` response, in which case no data should have been taken.
+ *          Up to @ref EZBUS_SOCKET_RX_PARCELS received parcels queue per socket, in blocks drawn from
+ *          the pool of the mac, so data left unread is kept, and further parcels are acknowledged 
+ *          for as long as there is room.
+ * @param mac The MAC interface instance the socket belongs to.
  * @param socket Integer value that references the given socket connection, @ref ezbus_socket_open()
  *          The local socket to reply on will be resocketed by invoking @ref ezbus_packet_dst_socket().
  * @param data Pointer to the destination storage for received bytes. Storage must be large enough to store `size` bytes.
- * @param size The maximum number of bytes to extract from the parcel packet.
- * @return The number of bytes actually copied to `data`. 
+ * @param size The maximum number of bytes to extract. A read stops at the end of a message.
+ * @return The number of bytes actually copied to `data`, 0 once all received bytes have been read. 
+ */
+extern int ezbus_socket_recv ( ezbus_mac_t* mac, ezbus_socket_t socket, void* data, size_t size );
+
+/**
+ * @brief Zero-copy alternative to @ref ezbus_socket_recv(). Lends the received bytes in place,
+ *          up to the end of the message, for the consumer to read or parse, and then pass to
+ *          @ref ezbus_socket_release(). Within the receive callback, a parcel arriving with
+ *          nothing queued ahead of it is lent straight from the receiver, and bytes not released
+ *          by the time the callback returns are queued in a pool block. The lent bytes stay
+ *          valid until released, or until the receive callback returns, whichever is first.
+ * @param mac The MAC interface instance the socket belongs to.
+ * @param socket Integer value that references the given socket connection, @ref ezbus_socket_open()
+ * @param size Receives the number of bytes lent. A chained message is lent one parcel at a time,
+ *          the next parcel is lent by the next borrow, after the first has been released.
+ * @return Pointer to the received bytes, or NULL if there are none, or the socket is not open.
+ */
+extern const void* ezbus_socket_borrow ( ezbus_mac_t* mac, ezbus_socket_t socket, size_t* size );
+
+/**
+ * @brief Hands back bytes lent by @ref ezbus_socket_borrow(), freeing their room for further parcels.
+ * @param size The number of bytes consumed, from the start of those lent.
+ */
+extern void ezbus_socket_release ( ezbus_mac_t* mac, ezbus_socket_t socket, size_t size );
+
+/**
+ * @brief The receive callback is invoked as each message completes, and for a chained message,
+ *          also whenever the socket, or the pool, has no room left for another parcel.
+ * @return true when the data last taken by @ref ezbus_socket_recv() completed a message.
  */
-extern int ezbus_socket_recv ( ezbus_socket_t socket, void* data, size_t size );
+extern bool ezbus_socket_recv_end ( ezbus_mac_t* mac, ezbus_socket_t socket );
 
 /**
  * @brief Open a tranceiver channel (socket) with a peer node.
@@ -115,7 +168,7 @@ extern int ezbus_socket_recv ( ezbus_socket_t socket, void* data, size_t size );
  * @return A new socket handle, or EZBUS_SOCKET_INVALID if the request could not be successfuly 
  *          completed. See @ref ezbus_socket_err(). Most likely cause of faulure is that
  *          @ref ezbus_socket_count() has reached @ref ezbus_socket_mac(). A finite number
- *          of sockets may be open at any one time, as defined by @ref EZBUS_NUM_SOCKETS.
+ *          of sockets may be open on each mac at any one time, as defined by @ref EZBUS_MAX_SOCKETS.
  *          When an unsolicited packet arrives when no more sockets are available, the
  *          incoming parcel packet is rejected with a 'nack'.
  */
@@ -126,12 +179,12 @@ extern ezbus_socket_t ezbus_socket_open ( ezbus_mac_t* mac, ezbus_address_t* pee
  * @brief Close a previously opened socket. Once invoked, the socket can no longer be
  *          referenced. See also @ref ezbus_socket_open()
  */
-extern void ezbus_socket_close ( ezbus_socket_t socket );
+extern void ezbus_socket_close ( ezbus_mac_t* mac, ezbus_socket_t socket );
 
 /**
  * @brief Used to determine if a given socket is currently open and available for use.
  */
-extern bool ezbus_socket_is_open ( ezbus_socket_t socket );
+extern bool ezbus_socket_is_open ( ezbus_mac_t* mac, ezbus_socket_t socket );
 
 #ifdef __cplusplus
 }
@@ -30,10 +30,16 @@
 #include <ezbus_packet.h>
 #include <ezbus_parcel.h>
 #include <ezbus_log.h>
+#include <ezbus_platform.h>
 
-static ezbus_socket_t next_tx_socket=0;
-static ezbus_socket_t ezbus_socket_cycle_next   ( void );
-static ezbus_socket_t ezbus_socket_peer_is_open ( ezbus_address_t* peer_address, ezbus_socket_t peer_socket );
+static ezbus_socket_t ezbus_socket_cycle_next   ( ezbus_mac_t* mac );
+static ezbus_socket_t ezbus_socket_peer_is_open ( ezbus_mac_t* mac, ezbus_address_t* peer_address, ezbus_socket_t peer_socket );
+static bool           ezbus_socket_deliver      ( ezbus_mac_t* mac, ezbus_socket_t socket, ezbus_packet_t* rx_packet );
+static bool           ezbus_socket_send_ready   ( ezbus_mac_t* mac, ezbus_socket_t socket );
+static bool           ezbus_socket_offer        ( ezbus_mac_t* mac, ezbus_socket_t socket );
+static bool           ezbus_socket_recv_ready   ( ezbus_mac_t* mac, ezbus_socket_t socket );
+static void           ezbus_socket_ack_rewind   ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq );
+static bool           ezbus_socket_seq_in_flight( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq );
 
 extern void ezbus_socket_callback_run( ezbus_mac_t* mac )
 {
@@ -42,26 +48,40 @@ extern void ezbus_socket_callback_run( ezbus_mac_t* mac )
     //     // if ( ezbus_socket_keepalive_expired( mac, socket ) )
     //     // {
     //     //     EZBUS_LOG( EZBUS_LOG_TIMEOUT, "keepalive expired socket #%d", socket );
-    //     //     ezbus_socket_close( socket );
+    //     //     ezbus_socket_close( mac, socket );
     //     // }
     // }
 }
 
 
-extern bool ezbus_socket_callback_transmitter_empty( ezbus_mac_t* mac )
+extern bool ezbus_socket_callback_transmitter_empty( ezbus_mac_t* mac, bool urgent_only )
 {
+    /* real-time sockets are offered the transmitter ahead of the bulk sockets */
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        if ( ezbus_socket_get_urgent( mac, socket ) && ezbus_socket_offer( mac, socket ) )
+        {
+            return true;
+        }
+    }
+    if ( urgent_only )
+    {
+        return false;
+    }
+
     /* 
      * The mac transmitter buffer has become available.
-     * attempt to give all sockets a fair shake at transmitting 
+     * attempt to give all sockets a fair shake at transmitting, one scan offers
+     * every socket and the any-socket slot, so false means none had data.
      */
-    for( int n=0; n < ezbus_socket_get_max(); n++ )
+    for( int n=0; n <= ezbus_socket_get_max(); n++ )
     {
-        ezbus_socket_t socket = ezbus_socket_cycle_next();
+        ezbus_socket_t socket = ezbus_socket_cycle_next( mac );
         if ( socket < ezbus_socket_get_max() )
         {
-            if ( ezbus_socket_is_open( socket ) )
+            if ( ezbus_socket_is_open( mac, socket ) && !ezbus_socket_get_urgent( mac, socket ) )
             {
-                if ( ezbus_socket_callback_send ( socket ) )
+                if ( ezbus_socket_offer( mac, socket ) )
                 {
                     return true;
                 }
@@ -70,40 +90,223 @@ extern bool ezbus_socket_callback_transmitter_empty( ezbus_mac_t* mac )
         else
         {
             /* On every socket scan period, any can send */
-            return ezbus_socket_callback_send ( EZBUS_SOCKET_ANY );
+            if ( ezbus_socket_send_ready( mac, EZBUS_SOCKET_ANY ) )
+            {
+                return true;
+            }
         }
     }
     return false;
 }
 
-static ezbus_socket_t ezbus_socket_cycle_next( void )
+static bool ezbus_socket_offer( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ++next_tx_socket > ezbus_socket_get_max() ) 
-        next_tx_socket = 0;
-    return next_tx_socket;
+    /* parcels rewound by a nack or a retransmit go out ahead of new data */
+    if ( ezbus_socket_transmit_next( mac, socket ) )
+    {
+        return true;
+    }
+    if ( ezbus_socket_get_tx_pending( mac, socket ) < ezbus_socket_get_tx_window_size( mac, socket ) )
+    {
+        return ezbus_socket_send_ready( mac, socket );
+    }
+    return false;
 }
 
-extern bool ezbus_socket_callback_transmitter_resend( ezbus_mac_t* mac )
+static ezbus_socket_t ezbus_socket_cycle_next( ezbus_mac_t* mac )
 {
-    ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet ( mac );
-    ezbus_socket_t  socket    = ezbus_packet_dst_socket       ( rx_packet );
-    ezbus_packet_t* tx_packet = ezbus_socket_get_tx_packet    ( socket );
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    if ( ++table->next_tx_socket > ezbus_socket_get_max() ) 
+        table->next_tx_socket = 0;
+    return table->next_tx_socket;
+}
+
+static bool ezbus_socket_send_ready( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    return table->callback_send != NULL && table->callback_send( mac, socket, table->callback_arg );
+}
 
-    if ( tx_packet != NULL )
+static bool ezbus_socket_recv_ready( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    /* with no consumer to take the data, the parcel is acknowledged and dropped */
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    return table->callback_recv == NULL || table->callback_recv( mac, socket, table->callback_arg );
+}
+
+static ezbus_ms_tick_t ezbus_socket_ack_period( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    /* from the measured round trip of the socket's own peer, doubled for each retransmission since its window last moved */
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    ezbus_ms_tick_t period  = ezbus_mac_peers_retransmit_time( mac, ezbus_socket_get_peer_address( mac, socket ) );
+    uint8_t         backoff = EZBUS_RETRANSMIT_TRIES - socket_state->tx_ack_tries;
+
+    while ( backoff-- > 0 && period < EZBUS_RETRANSMIT_TIME_MAX )
     {
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "%d", socket );
-        ezbus_packet_t* tx_packet = ezbus_socket_get_tx_packet( socket );
-        ezbus_mac_transmitter_put( mac, tx_packet );
-        return true;
+        period <<= 1;
     }
-    else
+    return ( period > EZBUS_RETRANSMIT_TIME_MAX ) ? EZBUS_RETRANSMIT_TIME_MAX : period;
+}
+
+extern void ezbus_socket_callback_transmitter_wait( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq )
+{
+    /* the wait runs from the end of the hold in which the oldest outstanding parcel was last sent */
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "??" );
-        return false;
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( !socket_state->tx_ack_wait || seq == socket_state->tx_ack_seq )
+        {
+            socket_state->tx_ack_wait  = true;
+            socket_state->tx_ack_hold  = true;
+            socket_state->tx_ack_start = ezbus_platform.callback_get_ms_ticks();
+        }
+    }
+}
+
+extern void ezbus_socket_callback_transmitter_hold( ezbus_mac_t* mac, bool release )
+{
+    /* no peer can ack before this node hands on the token */
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( ezbus_socket_is_open( mac, socket ) && socket_state->tx_ack_hold )
+        {
+            socket_state->tx_ack_start = ezbus_platform.callback_get_ms_ticks();
+            socket_state->tx_ack_hold  = !release;
+        }
+    }
+}
+
+extern void ezbus_socket_callback_transmitter_expire( ezbus_mac_t* mac )
+{
+    /* go-back-N: rewind each socket whose peer has not acknowledged in time, or give up on it */
+    ezbus_ms_tick_t now = ezbus_platform.callback_get_ms_ticks();
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( ezbus_socket_is_open( mac, socket ) && socket_state->tx_ack_wait && 
+             now - socket_state->tx_ack_start >= ezbus_socket_ack_period( mac, socket ) )
+        {
+            if ( socket_state->tx_ack_tries > 0 )
+            {
+                EZBUS_LOG( EZBUS_LOG_SOCKET, "%d seq %d", socket, ezbus_socket_get_tx_ack_seq( mac, socket ) );
+                --socket_state->tx_ack_tries;
+                /* the wait starts again as the oldest parcel goes back out */
+                socket_state->tx_ack_wait = false;
+                socket_state->tx_ack_hold = false;
+                ezbus_socket_ack_rewind( mac, socket, ezbus_socket_get_tx_ack_seq( mac, socket ) );
+            }
+            else
+            {
+                EZBUS_LOG( EZBUS_LOG_SOCKET, "retransmit limit, closing socket #%d", socket );
+                ezbus_socket_close( mac, socket );
+            }
+        }
+    }
+}
+
+extern bool ezbus_socket_callback_transmitter_deadline( ezbus_mac_t* mac, ezbus_ms_tick_t* deadline )
+{
+    /* the earliest of the socket deadlines, which may already have passed */
+    bool waiting = false;
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( ezbus_socket_is_open( mac, socket ) && socket_state->tx_ack_wait )
+        {
+            ezbus_ms_tick_t socket_deadline = socket_state->tx_ack_start + ezbus_socket_ack_period( mac, socket );
+            if ( !waiting || (int32_t)( socket_deadline - *deadline ) < 0 )
+            {
+                *deadline = socket_deadline;
+            }
+            waiting = true;
+        }
+    }
+    return waiting;
+}
+
+extern bool ezbus_socket_callback_transmitter_first( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq )
+{
+    if ( ezbus_socket_seq_in_flight( mac, socket, seq ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return !socket_state->tx_resent || 
+               (uint8_t)( seq - socket_state->tx_ack_seq ) >= (uint8_t)( socket_state->tx_resent_seq - socket_state->tx_ack_seq );
+    }
+    return false;
+}
+
+static void ezbus_socket_ack_rewind( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq )
+{
+    /* go back to seq, what was on the wire from there on is marked as going out again */
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    uint8_t next_seq = socket_state->tx_next_seq;
+
+    if ( next_seq != seq )
+    {
+        if ( !socket_state->tx_resent || (uint8_t)( next_seq - seq ) > (uint8_t)( socket_state->tx_resent_seq - seq ) )
+        {
+            socket_state->tx_resent_seq = next_seq;
+        }
+        socket_state->tx_resent = true;
+    }
+    ezbus_socket_set_tx_next_seq( mac, socket, seq );
+}
+
+static void ezbus_socket_ack_progress( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    /* the peer answered, the wait for what remains outstanding starts afresh */
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    socket_state->tx_ack_tries = EZBUS_RETRANSMIT_TRIES;
+    socket_state->tx_ack_hold  = false;
+    socket_state->tx_ack_wait  = ( socket_state->tx_next_seq != socket_state->tx_ack_seq );
+    socket_state->tx_ack_start = ezbus_platform.callback_get_ms_ticks();
+    if ( socket_state->tx_resent && (uint8_t)( socket_state->tx_ack_seq - socket_state->tx_resent_seq ) < 0x80 )
+    {
+        /* the window has moved past the last resent parcel, its acks time round trips again */
+        socket_state->tx_resent = false;
+    }
+}
+
+extern bool ezbus_socket_callback_transmitter_urgent( ezbus_mac_t* mac )
+{
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        /* parcels in the window not yet on the wire, a long message or a rewind after a nack */
+        if ( ezbus_socket_get_urgent( mac, socket ) && 
+             ezbus_socket_get_tx_next_seq( mac, socket ) != ezbus_socket_get_tx_seq( mac, socket ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+extern bool ezbus_socket_callback_urgent_open( ezbus_mac_t* mac )
+{
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        if ( ezbus_socket_get_urgent( mac, socket ) )
+        {
+            return true;
+        }
     }
+    return false;
 }
 
-static ezbus_socket_t ezbus_socket_peer_is_open( ezbus_address_t* peer_address, ezbus_socket_t peer_socket )
+extern bool ezbus_socket_callback_transmitter_busy( ezbus_mac_t* mac )
+{
+    for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
+    {
+        if ( ezbus_socket_is_open( mac, socket ) && ezbus_socket_get_tx_pending( mac, socket ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static ezbus_socket_t ezbus_socket_peer_is_open( ezbus_mac_t* mac, ezbus_address_t* peer_address, ezbus_socket_t peer_socket )
 {
     /*
      * Determine of the socket has already been opened by the peer,
@@ -111,11 +314,11 @@ static ezbus_socket_t ezbus_socket_peer_is_open( ezbus_address_t* peer_address,
      */
     for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
     {
-        if ( ezbus_socket_get_mac( socket ) != NULL )
+        if ( ezbus_socket_is_open( mac, socket ) )
         {
-            if ( ezbus_address_compare( peer_address, ezbus_socket_get_peer_address( socket ) ) == 0 )
+            if ( ezbus_address_compare( peer_address, ezbus_socket_get_peer_address( mac, socket ) ) == 0 )
             {
-                if ( peer_socket == ezbus_socket_get_peer_socket( socket ) )
+                if ( peer_socket == ezbus_socket_get_peer_socket( mac, socket ) )
                 {
                     return socket;
                 }
@@ -125,6 +328,76 @@ static ezbus_socket_t ezbus_socket_peer_is_open( ezbus_address_t* peer_address,
     return EZBUS_SOCKET_ANY;
 }
 
+static bool ezbus_socket_deliver( ezbus_mac_t* mac, ezbus_socket_t socket, ezbus_packet_t* rx_packet )
+{
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    ezbus_parcel_t* rx_parcel = ezbus_packet_get_parcel( rx_packet );
+    uint16_t chain            = ezbus_packet_chain( rx_packet );
+    size_t size               = ezbus_parcel_get_size( rx_parcel );
+    bool begin                = ( chain == PACKET_BITS_CHAIN_SINGLE || chain == PACKET_BITS_CHAIN_BEGIN );
+    bool end                  = ( chain == PACKET_BITS_CHAIN_SINGLE || chain == PACKET_BITS_CHAIN_LAST );
+    uint8_t rx_queue_head     = socket_state->rx_queue_head;
+    bool rx_chained           = socket_state->rx_chained;
+
+    if ( end && !( begin && rx_chained ) && socket_state->rx_queue_head == socket_state->rx_queue_tail )
+    {
+        /* nothing queued ahead of it, lend the parcel in place rather than copy it into a pool block */
+        const uint8_t* data = ezbus_parcel_get_ptr( rx_parcel );
+        bool ready;
+
+        socket_state->rx_lent      = data;
+        socket_state->rx_lent_size = size;
+        socket_state->rx_lent_end  = end;
+        ready = ezbus_socket_recv_ready( mac, socket );
+
+        if ( !ezbus_socket_is_open( mac, socket ) )
+        {
+            return ready;
+        }
+        size = socket_state->rx_lent_size;
+        socket_state->rx_lent      = NULL;
+        socket_state->rx_lent_size = 0;
+        if ( !ready )
+        {
+            /* refused, the peer will send the parcel again */
+            return false;
+        }
+        if ( size || socket_state->rx_lent_end )
+        {
+            /* whatever the consumer left behind is queued */
+            return ezbus_socket_rx_put( mac, socket, &data[ ezbus_parcel_get_size( rx_parcel ) - size ], size, false, end );
+        }
+        socket_state->rx_chained = false;
+        return true;
+    }
+
+    if ( !ezbus_socket_rx_put( mac, socket, ezbus_parcel_get_ptr( rx_parcel ), size, begin, end ) )
+    {
+        /* the queue is full, give the consumer a chance to make room */
+        if ( !ezbus_socket_recv_ready( mac, socket ) ||
+             !ezbus_socket_rx_put( mac, socket, ezbus_parcel_get_ptr( rx_parcel ), size, begin, end ) )
+        {
+            return false;
+        }
+    }
+
+    if ( end || (uint8_t)( socket_state->rx_queue_head - socket_state->rx_queue_tail ) == EZBUS_SOCKET_RX_PARCELS ||
+         ezbus_pool_available( ezbus_socket_get_pool( mac ) ) == 0 )
+    {
+        if ( !ezbus_socket_recv_ready( mac, socket ) )
+        {
+            /* refused, the peer will send the parcel again */
+            while ( socket_state->rx_queue_head != rx_queue_head && socket_state->rx_queue_head != socket_state->rx_queue_tail )
+            {
+                ezbus_pool_free( ezbus_socket_get_pool( mac ), socket_state->rx_queue[ --socket_state->rx_queue_head % EZBUS_SOCKET_RX_PARCELS ] );
+            }
+            socket_state->rx_chained = rx_chained;
+            return false;
+        }
+    }
+    return true;
+}
+
 extern bool ezbus_socket_callback_receiver_ready( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
     ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet ( mac );
@@ -135,65 +408,130 @@ extern bool ezbus_socket_callback_receiver_ready( ezbus_mac_t* mac, ezbus_packet
     if ( src_socket == EZBUS_SOCKET_ANY )
     {
         EZBUS_LOG( EZBUS_LOG_SOCKET, "peer close; socket #%d", dst_socket );
-        ezbus_socket_close( dst_socket );
+        ezbus_socket_close( mac, dst_socket );
         return true;
     }
         
-    dst_socket = ezbus_socket_peer_is_open( peer, src_socket );
+    dst_socket = ezbus_socket_peer_is_open( mac, peer, src_socket );
     
     if ( dst_socket == EZBUS_SOCKET_ANY )
     {
         EZBUS_LOG( EZBUS_LOG_SOCKET, "peer open; peer socket #%d", src_socket );
         dst_socket = ezbus_socket_open( mac, peer, src_socket );
+        if ( dst_socket != EZBUS_SOCKET_ANY )
+        {
+            /* the peer's stream may be well under way, after this node restarted, it is joined where it stands */
+            ezbus_socket_set_rx_seq( mac, dst_socket, ezbus_packet_seq( rx_packet ) );
+            if ( ezbus_packet_urgent( rx_packet ) )
+            {
+                /* the reply to an alarm or a control message is as pressing */
+                ezbus_socket_set_urgent( mac, dst_socket, true );
+            }
+        }
     }
 
     if ( dst_socket != EZBUS_SOCKET_ANY )
     {
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "RX READY; peer socket #%d", dst_socket );
-        ezbus_packet_copy( ezbus_socket_get_rx_packet( dst_socket ), rx_packet );
-        ezbus_packet_set_dst_socket( ezbus_socket_get_rx_packet( dst_socket ), dst_socket );
+        uint8_t rx_seq = ezbus_socket_get_rx_seq( mac, dst_socket );
+
         ezbus_packet_set_dst_socket( rx_packet, dst_socket );
-        return ezbus_socket_callback_recv( dst_socket );
+
+        if ( ezbus_packet_seq( rx_packet ) != rx_seq )
+        {
+            EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d seq %d expected %d", dst_socket, ezbus_packet_seq( rx_packet ), rx_seq );
+            if ( (uint8_t)( rx_seq - ezbus_packet_seq( rx_packet ) ) <= EZBUS_SOCKET_WINDOW )
+            {
+                /* a duplicate, its ack was lost, re-acknowledge the last in-order parcel */
+                ezbus_packet_set_seq( rx_packet, rx_seq-1 );
+                return true;
+            }
+            /* a gap, a parcel was lost, nack so the peer goes back to rx_seq at once */
+            ezbus_packet_set_seq( rx_packet, rx_seq );
+            return false;
+        }
+
+        EZBUS_LOG( EZBUS_LOG_SOCKET, "RX READY; peer socket #%d", dst_socket );
+        if ( ezbus_socket_deliver( mac, dst_socket, rx_packet ) )
+        {
+            ezbus_socket_set_rx_seq( mac, dst_socket, rx_seq+1 );
+            return true;
+        }
     }
 
     return false;
 }
 
-extern void ezbus_socket_callback_transmitter_ack( ezbus_mac_t* mac )
+static ezbus_socket_t ezbus_socket_ack_socket( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
-    ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet ( mac );
-    ezbus_socket_t socket     = ezbus_packet_dst_socket       ( rx_packet );
-    
-    EZBUS_LOG( EZBUS_LOG_SOCKET, "%d", socket );
-    if ( socket != EZBUS_SOCKET_ANY && ezbus_socket_get_mac( socket ) == mac )
-    {
-        ezbus_socket_set_tx_seq( socket, ezbus_socket_get_tx_seq( socket ) + 1 );
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "seq %d", ezbus_socket_get_tx_seq( socket ) );
-    }
-    else
+    /* an ack/nack is only valid from the peer the socket is connected to */
+    ezbus_socket_t socket = ezbus_packet_dst_socket( packet );
+
+    if ( socket != EZBUS_SOCKET_ANY && ezbus_socket_is_open( mac, socket ) )
     {
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "??" );        
+        if ( ezbus_address_compare( ezbus_packet_src( packet ), ezbus_socket_get_peer_address( mac, socket ) ) == 0 )
+        {
+            return socket;
+        }
     }
+    return EZBUS_SOCKET_INVALID;
+}
+
+static bool ezbus_socket_seq_in_flight( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq )
+{
+    uint8_t offset = seq - ezbus_socket_get_tx_ack_seq( mac, socket );
+    return offset < ezbus_socket_get_tx_pending( mac, socket );
 }
 
-extern void ezbus_socket_callback_transmitter_nack( ezbus_mac_t* mac )
+extern bool ezbus_socket_callback_transmitter_ack( ezbus_mac_t* mac )
 {
     ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet ( mac );
-    ezbus_socket_t socket     = ezbus_packet_dst_socket       ( rx_packet );
-    
-    if ( socket != EZBUS_SOCKET_ANY && ezbus_socket_get_mac( socket ) == mac )
+    ezbus_socket_t socket     = ezbus_socket_ack_socket       ( mac, rx_packet );
+    uint8_t seq               = ezbus_packet_seq              ( rx_packet );
+
+    if ( socket != EZBUS_SOCKET_INVALID && ezbus_socket_seq_in_flight( mac, socket, seq ) )
     {
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "%d", socket );
+        /* cumulative, everything up to and including seq has arrived */
+        uint8_t ack_seq = seq+1;
+        if ( (uint8_t)( ezbus_socket_get_tx_next_seq( mac, socket ) - ezbus_socket_get_tx_ack_seq( mac, socket ) ) < (uint8_t)( ack_seq - ezbus_socket_get_tx_ack_seq( mac, socket ) ) )
+        {
+            ezbus_socket_set_tx_next_seq( mac, socket, ack_seq );
+        }
+        ezbus_socket_set_tx_ack_seq( mac, socket, ack_seq );
+        ezbus_socket_ack_progress( mac, socket );
+        EZBUS_LOG( EZBUS_LOG_SOCKET, "%d seq %d", socket, seq );
+        return true;
     }
-    else
+    EZBUS_LOG( EZBUS_LOG_SOCKET, "?? seq %d", seq );
+    return false;
+}
+
+extern bool ezbus_socket_callback_transmitter_nack( ezbus_mac_t* mac )
+{
+    ezbus_packet_t* rx_packet = ezbus_mac_get_receiver_packet ( mac );
+    ezbus_socket_t socket     = ezbus_socket_ack_socket       ( mac, rx_packet );
+    uint8_t seq               = ezbus_packet_seq              ( rx_packet );
+
+    if ( socket != EZBUS_SOCKET_INVALID && ezbus_socket_seq_in_flight( mac, socket, seq ) )
     {
-        EZBUS_LOG( EZBUS_LOG_SOCKET, "??" );        
+        /* everything before seq has arrived, resume from seq */
+        ezbus_socket_set_tx_ack_seq( mac, socket, seq );
+        ezbus_socket_ack_rewind( mac, socket, seq );
+        ezbus_socket_ack_progress( mac, socket );
+        EZBUS_LOG( EZBUS_LOG_SOCKET, "%d seq %d", socket, seq );
+        return true;
     }
+    EZBUS_LOG( EZBUS_LOG_SOCKET, "?? seq %d", seq );
+    return false;
 }
 
-extern void ezbus_socket_callback_transmitter_limit( ezbus_mac_t* mac )
+extern void ezbus_socket_callback_transmitter_release( ezbus_mac_t* mac, ezbus_packet_t* packet )
 {
-    EZBUS_LOG( EZBUS_LOG_SOCKET, "" );
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    if ( table->tx_orphan != NULL && ( packet == NULL || packet == table->tx_orphan ) )
+    {
+        ezbus_pool_free( ezbus_socket_get_pool( mac ), table->tx_orphan );
+        table->tx_orphan = NULL;
+    }
 }
 
 extern void ezbus_socket_callback_transmitter_fault( ezbus_mac_t* mac )
@@ -214,13 +552,13 @@ extern void ezbus_socket_callback_peer( ezbus_mac_t* mac, ezbus_address_t* peer_
     {
         for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
         {
-            ezbus_address_t* socket_peer_address = ezbus_socket_get_peer_address( socket );
+            ezbus_address_t* socket_peer_address = ezbus_socket_get_peer_address( mac, socket );
             if ( socket_peer_address )
             {
                 if ( ezbus_address_compare( socket_peer_address, peer_address ) == 0 )
                 {
                     EZBUS_LOG( EZBUS_LOG_SOCKET, "peer vanished, closing socket#%d", socket );
-                    ezbus_socket_close( socket );
+                    ezbus_socket_close( mac, socket );
                 }
             }
         }
@@ -231,7 +569,7 @@ extern bool ezbus_socket_callback_peer_active( ezbus_mac_t* mac, ezbus_address_t
 {
     for( ezbus_socket_t socket=0; socket < ezbus_socket_get_max(); socket++ )
     {
-        ezbus_address_t* socket_peer_address = ezbus_socket_get_peer_address( socket );
+        ezbus_address_t* socket_peer_address = ezbus_socket_get_peer_address( mac, socket );
         if ( socket_peer_address != NULL )
         {
             if ( ezbus_address_compare( socket_peer_address, peer_address ) == 0 )
@@ -31,11 +31,41 @@ extern "C" {
 #endif
 
 extern void ezbus_socket_callback_run               ( ezbus_mac_t* mac );
-extern bool ezbus_socket_callback_transmitter_empty ( ezbus_mac_t* mac );
-extern bool ezbus_socket_callback_transmitter_resend( ezbus_mac_t* mac );
-extern void ezbus_socket_callback_transmitter_ack   ( ezbus_mac_t* mac );
-extern void ezbus_socket_callback_transmitter_nack  ( ezbus_mac_t* mac );
-extern void ezbus_socket_callback_transmitter_limit ( ezbus_mac_t* mac );
+extern bool ezbus_socket_callback_transmitter_empty ( ezbus_mac_t* mac, bool urgent_only );
+extern bool ezbus_socket_callback_transmitter_busy  ( ezbus_mac_t* mac );
+/**
+ * @brief A parcel of the socket with an ack requested has gone out on the wire, start its wait.
+ */
+extern void ezbus_socket_callback_transmitter_wait  ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq );
+/**
+ * @brief A frame of the token hold has gone out, the waits of the sockets sending in this hold 
+ *        start again from it. The release is the token frame which ends the hold.
+ */
+extern void ezbus_socket_callback_transmitter_hold  ( ezbus_mac_t* mac, bool release );
+/**
+ * @brief Each socket past its deadline goes back to its oldest outstanding parcel, 
+ *        or is closed after EZBUS_RETRANSMIT_TRIES retransmissions with no answer.
+ */
+extern void ezbus_socket_callback_transmitter_expire( ezbus_mac_t* mac );
+/**
+ * @brief The tick of the earliest socket deadline, which may already have passed.
+ * @return false if no socket is waiting on an ack.
+ */
+extern bool ezbus_socket_callback_transmitter_deadline( ezbus_mac_t* mac, ezbus_ms_tick_t* deadline );
+/**
+ * @brief Karn, the parcel seq of an open socket is outstanding and has gone out only once, 
+ *        so its ack can time a round trip.
+ */
+extern bool ezbus_socket_callback_transmitter_first( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq );
+extern bool ezbus_socket_callback_transmitter_urgent( ezbus_mac_t* mac );
+extern bool ezbus_socket_callback_urgent_open       ( ezbus_mac_t* mac );
+extern bool ezbus_socket_callback_transmitter_ack   ( ezbus_mac_t* mac );
+extern bool ezbus_socket_callback_transmitter_nack  ( ezbus_mac_t* mac );
+/**
+ * @brief The transmitter has let go of the packet, or of every packet when NULL, 
+ *        a block left behind by a socket closed while it was on the wire goes back to the pool.
+ */
+extern void ezbus_socket_callback_transmitter_release( ezbus_mac_t* mac, ezbus_packet_t* packet );
 extern void ezbus_socket_callback_transmitter_fault ( ezbus_mac_t* mac );
 
 extern bool ezbus_socket_callback_receiver_ready    ( ezbus_mac_t* mac, ezbus_packet_t* packet );
@@ -22,128 +22,343 @@
 #include <ezbus_socket_common.h>
 #include <ezbus_socket.h>
 #include <ezbus_log.h>
+#include <ezbus_platform.h>
 #include <ezbus_mac_token.h>
-
-static EZBUS_ERR  global_socket_err=EZBUS_ERR_OKAY;
+#include <ezbus_mac_transmitter.h>
 
 extern size_t ezbus_socket_get_max( void )
 {
     return EZBUS_MAX_SOCKETS;
 }
 
-extern ezbus_socket_state_t* ezbus_socket_get_at( size_t index )
+extern size_t ezbus_socket_get_count( ezbus_mac_t* mac )
+{
+    return ezbus_mac_get_sockets( mac )->count;
+}
+
+extern ezbus_pool_t* ezbus_socket_get_pool( ezbus_mac_t* mac )
+{
+    return &ezbus_mac_get_sockets( mac )->pool;
+}
+
+extern ezbus_socket_state_t* ezbus_socket_get_at( ezbus_mac_t* mac, size_t index )
 {
     if ( index < ezbus_socket_get_max() )
     {
-        return &ezbus_sockets[index];
+        return &ezbus_mac_get_sockets( mac )->sockets[index];
     }
     return NULL;
 }
 
-extern ezbus_mac_t* ezbus_socket_get_mac( ezbus_socket_t socket )
+extern ezbus_address_t* ezbus_socket_get_peer_address( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( socket >= 0 && socket < ezbus_socket_get_max() )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
-        return socket_state->mac;
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return &socket_state->peer_address;
     }
-    else
+    return NULL;
+}
+
+extern ezbus_socket_t ezbus_socket_get_peer_socket( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        global_socket_err=EZBUS_ERR_RANGE;
-        return NULL;
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return socket_state->peer_socket;
     }
+    return EZBUS_SOCKET_INVALID;
+}
+
+extern ezbus_packet_t* ezbus_socket_get_tx_packet( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    /* the window slot that the next new sequence number will occupy, NULL until drawn from the pool */
+    return ezbus_socket_get_tx_window_packet( mac, socket, ezbus_socket_get_tx_seq( mac, socket ) );
 }
 
-extern ezbus_address_t* ezbus_socket_get_peer_address( ezbus_socket_t socket )
+extern ezbus_packet_t* ezbus_socket_get_tx_window_packet( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq )
 {
-    if ( ezbus_socket_is_open(socket) )
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    if ( socket_state != NULL )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
-        return ezbus_packet_src( &socket_state->rx_packet );
+        return socket_state->tx_window[ seq % EZBUS_SOCKET_WINDOW ];
     }
+    ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_RANGE;
     return NULL;
 }
 
-extern ezbus_socket_t ezbus_socket_get_peer_socket( ezbus_socket_t socket )
+extern size_t ezbus_socket_get_rx_size( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ezbus_socket_is_open(socket) )
+    /* bytes which ezbus_socket_recv() may take before the next message end */
+    size_t size = 0;
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
-        return ezbus_packet_src_socket( &socket_state->rx_packet );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( socket_state->rx_lent != NULL )
+        {
+            return socket_state->rx_lent_size;
+        }
+        for( uint8_t queued=socket_state->rx_queue_tail; queued != socket_state->rx_queue_head; queued++ )
+        {
+            ezbus_packet_t* rx_block = socket_state->rx_queue[ queued % EZBUS_SOCKET_RX_PARCELS ];
+            size += ezbus_parcel_get_size( ezbus_packet_get_parcel( rx_block ) );
+            if ( ezbus_packet_chain( rx_block ) == PACKET_BITS_CHAIN_LAST )
+            {
+                break;
+            }
+        }
+        size -= socket_state->rx_offset;
     }
-    return EZBUS_SOCKET_INVALID;
+    return size;
 }
 
-extern ezbus_packet_t* ezbus_socket_get_tx_packet( ezbus_socket_t socket )
+static void ezbus_socket_rx_push( ezbus_mac_t* mac, ezbus_socket_t socket, const void* data, size_t size, bool end )
 {
-    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
-    if ( socket_state != NULL )
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    ezbus_packet_t* rx_block = (ezbus_packet_t*)ezbus_pool_alloc( ezbus_socket_get_pool( mac ) );
+
+    /* a queued parcel only keeps its payload, and whether it ends a message */
+    ezbus_packet_set_chain( rx_block, end ? PACKET_BITS_CHAIN_LAST : PACKET_BITS_CHAIN_MIDDLE );
+    ezbus_parcel_set_data( ezbus_packet_get_parcel( rx_block ), data, size );
+    socket_state->rx_queue[ socket_state->rx_queue_head++ % EZBUS_SOCKET_RX_PARCELS ] = rx_block;
+}
+
+extern bool ezbus_socket_rx_put( ezbus_mac_t* mac, ezbus_socket_t socket, const void* data, size_t size, bool begin, bool end )
+{
+    /* queue received bytes in a pool block, all or nothing, begin and end delimit a message */
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        return &socket_state->tx_packet;
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        uint8_t  queued   = socket_state->rx_queue_head - socket_state->rx_queue_tail;
+        bool     truncate = begin && socket_state->rx_chained;
+        uint8_t  blocks   = ( truncate && !queued ) ? 2 : 1;
+
+        if ( queued + blocks > EZBUS_SOCKET_RX_PARCELS || ezbus_pool_available( ezbus_socket_get_pool( mac ) ) < blocks )
+        {
+            return false;
+        }
+
+        if ( truncate )
+        {
+            /* the rest of the previous message never came, deliver what did as a message of its own */
+            if ( queued )
+            {
+                ezbus_packet_set_chain( socket_state->rx_queue[ (uint8_t)(socket_state->rx_queue_head-1) % EZBUS_SOCKET_RX_PARCELS ], PACKET_BITS_CHAIN_LAST );
+            }
+            else
+            {
+                ezbus_socket_rx_push( mac, socket, NULL, 0, true );
+            }
+        }
+        ezbus_socket_rx_push( mac, socket, data, size, end );
+        socket_state->rx_chained = !end;
+        return true;
     }
-    global_socket_err=EZBUS_ERR_RANGE;
-    return NULL;
+    return false;
 }
 
-extern ezbus_packet_t* ezbus_socket_get_rx_packet( ezbus_socket_t socket )
+extern void ezbus_socket_rx_pop( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
-    if ( socket_state != NULL )
+    ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+    if ( socket_state->rx_queue_tail != socket_state->rx_queue_head )
     {
-        return &socket_state->rx_packet;
+        ezbus_pool_free( ezbus_socket_get_pool( mac ), socket_state->rx_queue[ socket_state->rx_queue_tail++ % EZBUS_SOCKET_RX_PARCELS ] );
+        socket_state->rx_offset = 0;
     }
-    global_socket_err=EZBUS_ERR_RANGE;
-    return NULL;
 }
 
-extern uint8_t ezbus_socket_get_tx_seq( ezbus_socket_t socket )
+extern uint8_t ezbus_socket_get_tx_seq( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ezbus_socket_is_open(socket) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         return socket_state->tx_seq;
     }
-    global_socket_err=EZBUS_ERR_NOTREADY;
+    ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
     return 0;
 }
 
-extern uint8_t ezbus_socket_get_rx_seq( ezbus_socket_t socket )
+extern uint8_t ezbus_socket_get_rx_seq( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ezbus_socket_is_open(socket) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         return socket_state->rx_seq;
     }
-    global_socket_err=EZBUS_ERR_NOTREADY;
+    ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
     return 0;
 }
 
-extern void ezbus_socket_set_tx_seq( ezbus_socket_t socket, uint8_t seq)
+extern void ezbus_socket_set_tx_seq( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq)
 {
-    if ( ezbus_socket_is_open(socket) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         socket_state->tx_seq = seq;
     }
-    global_socket_err=EZBUS_ERR_NOTREADY;
+    else
+    {
+        ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    }
 }
 
-extern void ezbus_socket_set_rx_seq( ezbus_socket_t socket, uint8_t seq)
+extern void ezbus_socket_set_rx_seq( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq)
 {
-    if ( ezbus_socket_is_open(socket) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         socket_state->rx_seq = seq;
     }
-    global_socket_err=EZBUS_ERR_NOTREADY;
+    else
+    {
+        ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    }
+}
+
+extern uint8_t ezbus_socket_get_tx_ack_seq( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return socket_state->tx_ack_seq;
+    }
+    ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    return 0;
+}
+
+extern void ezbus_socket_set_tx_ack_seq( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq)
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+
+        /* acknowledged parcels go back to the pool, unless one is on the wire right now */
+        for( ; socket_state->tx_ack_seq != seq; socket_state->tx_ack_seq++ )
+        {
+            ezbus_packet_t** slot = &socket_state->tx_window[ socket_state->tx_ack_seq % EZBUS_SOCKET_WINDOW ];
+            if ( *slot != NULL && ezbus_mac_transmitter_drop( mac, *slot ) )
+            {
+                ezbus_pool_free( ezbus_socket_get_pool( mac ), *slot );
+                *slot = NULL;
+            }
+        }
+    }
+    else
+    {
+        ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    }
+}
+
+extern uint8_t ezbus_socket_get_tx_next_seq( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return socket_state->tx_next_seq;
+    }
+    ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    return 0;
+}
+
+extern void ezbus_socket_set_tx_next_seq( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq)
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        socket_state->tx_next_seq = seq;
+    }
+    else
+    {
+        ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    }
 }
 
+extern uint8_t ezbus_socket_get_tx_window_size( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return socket_state->tx_window_size;
+    }
+    ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    return 0;
+}
 
-extern EZBUS_ERR ezbus_socket_get_err( ezbus_socket_t socket )
+extern void ezbus_socket_set_tx_window_size( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t size )
 {
-    if ( socket >= 0 && socket < ezbus_socket_get_max() )
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( size < 1 )
+            size = 1;
+        if ( size > EZBUS_SOCKET_WINDOW )
+            size = EZBUS_SOCKET_WINDOW;
+        socket_state->tx_window_size = size;
+    }
+    else
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    }
+}
+
+extern void ezbus_socket_set_urgent( ezbus_mac_t* mac, ezbus_socket_t socket, bool urgent )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        socket_state->tx_urgent = urgent;
+    }
+    else
+    {
+        ezbus_mac_get_sockets( mac )->err=EZBUS_ERR_NOTREADY;
+    }
+}
+
+extern bool ezbus_socket_get_urgent( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return socket_state->tx_urgent;
+    }
+    return false;
+}
+
+extern uint8_t ezbus_socket_get_tx_pending( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    /* parcels sent, or waiting to be sent, and not yet acknowledged */
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        return (uint8_t)( socket_state->tx_seq - socket_state->tx_ack_seq );
+    }
+    return 0;
+}
+
+
+extern bool ezbus_socket_transmit_next( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    /* queue the oldest parcel not yet (re-)transmitted, the transmitter sends it from the window in place */
+    if ( ezbus_socket_is_open( mac, socket ) )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        if ( socket_state->tx_next_seq != socket_state->tx_seq &&
+             ezbus_mac_transmitter_put_ref( mac, socket_state->tx_window[ socket_state->tx_next_seq % EZBUS_SOCKET_WINDOW ] ) )
+        {
+            /* a full queue leaves it unsent, it goes out on a later offer of the transmitter */
+            ++socket_state->tx_next_seq;
+            return true;
+        }
+    }
+    return false;
+}
+
+extern EZBUS_ERR ezbus_socket_get_err( ezbus_mac_t* mac, ezbus_socket_t socket )
+{
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    if ( socket < ezbus_socket_get_max() )
+    {
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         if ( socket_state->err != EZBUS_ERR_OKAY )
         {
             return socket_state->err;
@@ -151,51 +366,52 @@ extern EZBUS_ERR ezbus_socket_get_err( ezbus_socket_t socket )
     }
     else
     {
-        global_socket_err=EZBUS_ERR_RANGE;
+        table->err=EZBUS_ERR_RANGE;
     }
-    return global_socket_err;
+    return table->err;
 }
 
-extern void ezbus_socket_reset_err( ezbus_socket_t socket )
+extern void ezbus_socket_reset_err( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( socket >= 0 && socket < ezbus_socket_get_max() )
+    ezbus_socket_table_t* table = ezbus_mac_get_sockets( mac );
+    if ( socket < ezbus_socket_get_max() )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
-        socket_state->err = global_socket_err = EZBUS_ERR_OKAY;
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
+        socket_state->err = table->err = EZBUS_ERR_OKAY;
     }
     else
     {
-        global_socket_err=EZBUS_ERR_RANGE;
+        table->err=EZBUS_ERR_RANGE;
     }
 }
 
-extern void ezbus_socket_set_err( ezbus_socket_t socket, EZBUS_ERR err )
+extern void ezbus_socket_set_err( ezbus_mac_t* mac, ezbus_socket_t socket, EZBUS_ERR err )
 {
-    if ( socket >= 0 && socket < ezbus_socket_get_max() )
+    if ( socket < ezbus_socket_get_max() )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         socket_state->err = err;
     }
     else
     {
-        global_socket_err = err;
+        ezbus_mac_get_sockets( mac )->err = err;
     }
 }
 
 extern void ezbus_socket_keepalive_reset( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ezbus_socket_is_open(socket) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         socket_state->keepalive_start = ezbus_mac_token_ring_count( mac );
     }
 }
 
 extern bool ezbus_socket_keepalive_expired( ezbus_mac_t* mac, ezbus_socket_t socket )
 {
-    if ( ezbus_socket_is_open(socket) )
+    if ( ezbus_socket_is_open( mac, socket ) )
     {
-        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( socket );
+        ezbus_socket_state_t* socket_state = ezbus_socket_get_at( mac, socket );
         if ( ezbus_mac_token_ring_count_timeout( mac, socket_state->keepalive_start, EZBUS_KEEPALIVE_CYCLES ) )
         {
             EZBUS_LOG( EZBUS_LOG_TIMEOUT, "%d > %d", ezbus_mac_token_ring_count( mac ), socket_state->keepalive_start+EZBUS_KEEPALIVE_CYCLES );
@@ -204,4 +420,3 @@ extern bool ezbus_socket_keepalive_expired( ezbus_mac_t* mac, ezbus_socket_t soc
     }
     return false;
 }
-
@@ -26,47 +26,107 @@
 #include <ezbus_packet.h>
 #include <ezbus_mac.h>
 #include <ezbus_fault.h>
+#include <ezbus_pool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef bool (*ezbus_socket_callback_send_t)    ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg );
+typedef bool (*ezbus_socket_callback_recv_t)    ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg );
+typedef void (*ezbus_socket_callback_closing_t) ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg );
+
 typedef struct _ezbus_socket_state_t
 {
     ezbus_mac_t*        mac;
-    ezbus_packet_t      tx_packet;
-    ezbus_packet_t      rx_packet;
-    uint8_t             tx_seq;
-    uint8_t             rx_seq;
+    ezbus_address_t     peer_address;
+    ezbus_socket_t      peer_socket;
+    ezbus_packet_t*     tx_window[EZBUS_SOCKET_WINDOW]; /* pool blocks, NULL while unused */
+    uint8_t             tx_seq;         /* next sequence number to assign */
+    uint8_t             tx_ack_seq;     /* oldest un-acknowledged sequence number */
+    uint8_t             tx_next_seq;    /* next sequence number to put on the wire */
+    uint8_t             tx_window_size;
+    uint8_t             rx_seq;         /* next in-order sequence number expected */
+    ezbus_ms_tick_t     tx_ack_start;   /* the wait for the oldest outstanding parcel runs from here */
+    uint8_t             tx_ack_tries;   /* retransmissions left before the peer is given up on */
+    bool                tx_ack_wait;    /* parcels are on the wire and the wait is running */
+    bool                tx_ack_hold;    /* the wait restarts with each frame of the current token hold */
+    bool                tx_resent;      /* parcels before tx_resent_seq went out more than once */
+    uint8_t             tx_resent_seq;  /* end of the resent run, no ack within it times a round trip */
+    bool                tx_chained;     /* a message is part way through being segmented */
+    bool                tx_urgent;      /* real-time class, its parcels go ahead of bulk traffic */
+    bool                rx_chained;     /* part way through receiving a chained message */
+    bool                rx_message_end; /* the last ezbus_socket_recv() completed a message */
+    ezbus_packet_t*     rx_queue[EZBUS_SOCKET_RX_PARCELS]; /* pool blocks holding received parcels, oldest first */
+    uint8_t             rx_queue_head;  /* free running, next to be received */
+    uint8_t             rx_queue_tail;  /* free running, next to be read */
+    uint16_t            rx_offset;      /* bytes of the oldest already read */
+    const uint8_t*      rx_lent;        /* inbound parcel lent in place while the receive callback runs */
+    uint16_t            rx_lent_size;   /* bytes of it not yet taken */
+    bool                rx_lent_end;    /* it completes a message */
     EZBUS_ERR           err;
     uint32_t            keepalive_start;
 } ezbus_socket_state_t;
 
-extern ezbus_socket_state_t ezbus_sockets[];
+/**
+ * @brief The sockets belonging to one mac, and the application callbacks which serve them.
+ */
+typedef struct _ezbus_socket_table_t
+{
+    ezbus_socket_state_t            sockets[EZBUS_MAX_SOCKETS];
+    ezbus_pool_t                    pool;               /* parcel buffers, drawn as sockets need them */
+    ezbus_packet_t                  blocks[EZBUS_POOL_BLOCKS];
+    size_t                          count;
+    ezbus_socket_t                  next_tx_socket;     /* round-robin position of the transmit scan */
+    ezbus_packet_t*                 tx_orphan;          /* block of a closed socket still going out on the wire */
+    EZBUS_ERR                       err;                /* error not attributable to an open socket */
+    ezbus_socket_callback_send_t    callback_send;
+    ezbus_socket_callback_recv_t    callback_recv;
+    ezbus_socket_callback_closing_t callback_closing;
+    void*                           callback_arg;
+} ezbus_socket_table_t;
 
-extern ezbus_mac_t*             ezbus_socket_get_mac            ( ezbus_socket_t socket );
-extern ezbus_address_t*         ezbus_socket_get_peer_address   ( ezbus_socket_t socket );
-extern ezbus_socket_t           ezbus_socket_get_peer_socket    ( ezbus_socket_t socket );
-extern EZBUS_ERR                ezbus_socket_get_err            ( ezbus_socket_t socket );
-extern void                     ezbus_socket_set_err            ( ezbus_socket_t socket, EZBUS_ERR err );
-extern void                     ezbus_socket_reset_err          ( ezbus_socket_t socket );
+extern EZBUS_ERR                ezbus_socket_get_err            ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern void                     ezbus_socket_set_err            ( ezbus_mac_t* mac, ezbus_socket_t socket, EZBUS_ERR err );
+extern void                     ezbus_socket_reset_err          ( ezbus_mac_t* mac, ezbus_socket_t socket );
 extern size_t                   ezbus_socket_get_max            ( void );
-extern ezbus_socket_state_t*    ezbus_socket_get_at             ( size_t index );
+extern size_t                   ezbus_socket_get_count          ( ezbus_mac_t* mac );
+extern ezbus_socket_state_t*    ezbus_socket_get_at             ( ezbus_mac_t* mac, size_t index );
+extern ezbus_pool_t*            ezbus_socket_get_pool           ( ezbus_mac_t* mac );
+extern ezbus_address_t*         ezbus_socket_get_peer_address   ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern ezbus_socket_t           ezbus_socket_get_peer_socket    ( ezbus_mac_t* mac, ezbus_socket_t socket );
 
+extern ezbus_packet_t*          ezbus_socket_get_tx_packet      ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern uint8_t                  ezbus_socket_get_tx_seq         ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern void                     ezbus_socket_set_tx_seq         ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq);
+extern uint8_t                  ezbus_socket_get_tx_ack_seq     ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern void                     ezbus_socket_set_tx_ack_seq     ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq);
+extern uint8_t                  ezbus_socket_get_tx_next_seq    ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern void                     ezbus_socket_set_tx_next_seq    ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq);
+extern ezbus_packet_t*          ezbus_socket_get_tx_window_packet( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq );
+extern uint8_t                  ezbus_socket_get_tx_window_size ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern void                     ezbus_socket_set_tx_window_size ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t size );
+extern uint8_t                  ezbus_socket_get_tx_pending     ( ezbus_mac_t* mac, ezbus_socket_t socket );
+/**
+ * @brief Put the socket in the real-time class, for alarms and control, or back in the bulk class.
+ *        Its parcels are sent ahead of bulk parcels within a token hold, its node stays in the demand
+ *        rotation while it is open, and the ring calls early on a node owing its parcels or their
+ *        acknowledgement, see @ref PACKET_BITS_URGENT.
+ *        A socket opened by the arrival of a real-time parcel is put in the real-time class.
+ */
+extern void                     ezbus_socket_set_urgent         ( ezbus_mac_t* mac, ezbus_socket_t socket, bool urgent );
+extern bool                     ezbus_socket_get_urgent         ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern bool                     ezbus_socket_transmit_next      ( ezbus_mac_t* mac, ezbus_socket_t socket );
 
-extern ezbus_packet_t*          ezbus_socket_get_tx_packet      ( ezbus_socket_t socket );
-extern uint8_t                  ezbus_socket_get_tx_seq         ( ezbus_socket_t socket );
-extern void                     ezbus_socket_set_tx_seq         ( ezbus_socket_t socket, uint8_t seq);
-
-extern ezbus_packet_t*          ezbus_socket_get_rx_packet      ( ezbus_socket_t socket );
-extern uint8_t                  ezbus_socket_get_rx_seq         ( ezbus_socket_t socket );
-extern void                     ezbus_socket_set_rx_seq         ( ezbus_socket_t socket, uint8_t seq);
+extern size_t                   ezbus_socket_get_rx_size        ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern bool                     ezbus_socket_rx_put             ( ezbus_mac_t* mac, ezbus_socket_t socket, const void* data, size_t size, bool begin, bool end );
+extern void                     ezbus_socket_rx_pop             ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern uint8_t                  ezbus_socket_get_rx_seq         ( ezbus_mac_t* mac, ezbus_socket_t socket );
+extern void                     ezbus_socket_set_rx_seq         ( ezbus_mac_t* mac, ezbus_socket_t socket, uint8_t seq);
 
 extern void                     ezbus_socket_keepalive_reset    ( ezbus_mac_t* mac, ezbus_socket_t socket );
 extern bool                     ezbus_socket_keepalive_expired  ( ezbus_mac_t* mac, ezbus_socket_t socket );
 
-#define ezbus_socket_get_port(socket) ezbus_mac_get_port(ezbus_socket_get_mac(socket))
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,304 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#include <ezbus_thread.h>
+#include <ezbus_socket.h>
+#include <ezbus_log.h>
+#include <ezbus_platform.h>
+
+static bool ezbus_thread_socket_send    ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg );
+static bool ezbus_thread_socket_recv    ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg );
+static void ezbus_thread_socket_closing ( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg );
+static void ezbus_thread_post           ( ezbus_thread_t* thread, ezbus_thread_op_t op, ezbus_socket_t socket, uint32_t tag );
+static void ezbus_thread_do_control     ( ezbus_thread_t* thread, ezbus_thread_record_t* record );
+static ezbus_thread_record_t* ezbus_thread_reserve ( ezbus_thread_t* thread, ezbus_thread_op_t op, ezbus_socket_t socket );
+static void ezbus_thread_commit         ( ezbus_thread_t* thread );
+
+
+extern void ezbus_thread_init( ezbus_thread_t* thread, ezbus_t* ezbus )
+{
+    ezbus_platform.callback_memset( thread, 0, sizeof(ezbus_thread_t) );
+    thread->ezbus = ezbus;
+    ezbus_ring_init( &thread->tx_ring, thread->tx_records, sizeof(ezbus_thread_record_t), EZBUS_THREAD_RING_LN );
+    ezbus_ring_init( &thread->rx_ring, thread->rx_records, sizeof(ezbus_thread_record_t), EZBUS_THREAD_RING_LN );
+    ezbus_socket_init( ezbus_mac( ezbus ), ezbus_thread_socket_send, ezbus_thread_socket_recv, ezbus_thread_socket_closing, thread );
+}
+
+extern void ezbus_thread_set_idle_callback( 
+                                            ezbus_thread_t*              thread, 
+                                            ezbus_thread_idle_callback_t callback_idle,
+                                            ezbus_thread_wake_callback_t callback_wake,
+                                            void*                        arg
+                                          )
+{
+    thread->callback_idle = callback_idle;
+    thread->callback_wake = callback_wake;
+    thread->idle_arg      = arg;
+}
+
+extern void ezbus_thread_set_notify_callback( ezbus_thread_t* thread, ezbus_thread_wake_callback_t callback_notify, void* arg )
+{
+    thread->callback_notify = callback_notify;
+    thread->notify_arg      = arg;
+}
+
+extern void ezbus_thread_main( ezbus_thread_t* thread )
+{
+    while ( !__atomic_load_n( &thread->stop, __ATOMIC_ACQUIRE ) )
+    {
+        ezbus_ms_tick_t next = ezbus_thread_run( thread );
+        if ( next && thread->callback_idle )
+        {
+            thread->callback_idle( thread, next, thread->idle_arg );
+        }
+    }
+}
+
+extern ezbus_ms_tick_t ezbus_thread_run( ezbus_thread_t* thread )
+{
+    ezbus_mac_t* mac = ezbus_mac( thread->ezbus );
+    ezbus_thread_record_t* record;
+
+    /* opens and closes are taken in order, up to the first send, which waits for the transmitter */
+    while ( (record = ezbus_ring_peek( &thread->tx_ring )) != NULL )
+    {
+        if ( record->op == ezbus_thread_op_send )
+        {
+            if ( ezbus_socket_is_open( mac, record->socket ) )
+            {
+                break;
+            }
+            EZBUS_LOG( EZBUS_LOG_SOCKET, "socket #%d closed, send dropped", record->socket );
+            ++thread->tx_dropped;
+        }
+        else
+        {
+            ezbus_thread_do_control( thread, record );
+        }
+        ezbus_ring_release( &thread->tx_ring );
+    }
+
+    ezbus_run( thread->ezbus );
+
+    if ( thread->posted )
+    {
+        thread->posted = false;
+        if ( thread->callback_notify )
+        {
+            thread->callback_notify( thread, thread->notify_arg );
+        }
+    }
+
+    if ( (record = ezbus_ring_peek( &thread->tx_ring )) != NULL && record->op != ezbus_thread_op_send )
+    {
+        return 0;
+    }
+    return ezbus_next_wakeup( thread->ezbus );
+}
+
+extern void ezbus_thread_stop( ezbus_thread_t* thread )
+{
+    __atomic_store_n( &thread->stop, true, __ATOMIC_RELEASE );
+    if ( thread->callback_wake )
+    {
+        thread->callback_wake( thread, thread->idle_arg );
+    }
+}
+
+extern bool ezbus_thread_open( ezbus_thread_t* thread, ezbus_address_t* peer, ezbus_socket_t peer_socket, uint32_t tag )
+{
+    ezbus_thread_record_t* record = ezbus_thread_reserve( thread, ezbus_thread_op_open, EZBUS_SOCKET_INVALID );
+    if ( record != NULL )
+    {
+        ezbus_address_copy( &record->peer, peer );
+        record->peer_socket = peer_socket;
+        record->tag = tag;
+        ezbus_thread_commit( thread );
+        return true;
+    }
+    return false;
+}
+
+extern bool ezbus_thread_send( ezbus_thread_t* thread, ezbus_socket_t socket, void* data, size_t size )
+{
+    if ( size <= EZBUS_THREAD_RECORD_LN )
+    {
+        ezbus_thread_record_t* record = ezbus_thread_reserve( thread, ezbus_thread_op_send, socket );
+        if ( record != NULL )
+        {
+            ezbus_platform.callback_memcpy( record->data, data, size );
+            record->size = size;
+            ezbus_thread_commit( thread );
+            return true;
+        }
+    }
+    return false;
+}
+
+extern bool ezbus_thread_close( ezbus_thread_t* thread, ezbus_socket_t socket )
+{
+    if ( ezbus_thread_reserve( thread, ezbus_thread_op_close, socket ) != NULL )
+    {
+        ezbus_thread_commit( thread );
+        return true;
+    }
+    return false;
+}
+
+extern ezbus_thread_record_t* ezbus_thread_peek( ezbus_thread_t* thread )
+{
+    return (ezbus_thread_record_t*)ezbus_ring_peek( &thread->rx_ring );
+}
+
+extern void ezbus_thread_release( ezbus_thread_t* thread )
+{
+    ezbus_ring_release( &thread->rx_ring );
+}
+
+static ezbus_thread_record_t* ezbus_thread_reserve( ezbus_thread_t* thread, ezbus_thread_op_t op, ezbus_socket_t socket )
+{
+    ezbus_thread_record_t* record = (ezbus_thread_record_t*)ezbus_ring_reserve( &thread->tx_ring );
+    if ( record != NULL )
+    {
+        record->op     = op;
+        record->socket = socket;
+        record->offset = 0;
+        record->size   = 0;
+    }
+    return record;
+}
+
+static void ezbus_thread_commit( ezbus_thread_t* thread )
+{
+    ezbus_ring_commit( &thread->tx_ring );
+    if ( thread->callback_wake )
+    {
+        thread->callback_wake( thread, thread->idle_arg );
+    }
+}
+
+static void ezbus_thread_do_control( ezbus_thread_t* thread, ezbus_thread_record_t* record )
+{
+    ezbus_mac_t* mac = ezbus_mac( thread->ezbus );
+
+    switch( record->op )
+    {
+        case ezbus_thread_op_open:
+            ezbus_thread_post( thread, ezbus_thread_op_opened, ezbus_socket_open( mac, &record->peer, record->peer_socket ), record->tag );
+            break;
+        case ezbus_thread_op_close:
+            /* ezbus_thread_op_closed is posted by the closing callback */
+            ezbus_socket_close( mac, record->socket );
+            break;
+        default:
+            break;
+    }
+}
+
+static void ezbus_thread_post( ezbus_thread_t* thread, ezbus_thread_op_t op, ezbus_socket_t socket, uint32_t tag )
+{
+    ezbus_mac_t* mac = ezbus_mac( thread->ezbus );
+    ezbus_thread_record_t* record = (ezbus_thread_record_t*)ezbus_ring_reserve( &thread->rx_ring );
+
+    if ( record != NULL )
+    {
+        ezbus_address_t* peer = ezbus_socket_get_peer_address( mac, socket );
+        record->op          = op;
+        record->socket      = socket;
+        record->peer_socket = ezbus_socket_get_peer_socket( mac, socket );
+        record->tag         = tag;
+        record->end         = false;
+        record->size        = 0;
+        if ( peer != NULL )
+        {
+            ezbus_address_copy( &record->peer, peer );
+        }
+        ezbus_ring_commit( &thread->rx_ring );
+        thread->posted = true;
+    }
+    else
+    {
+        ++thread->rx_dropped;
+    }
+}
+
+static bool ezbus_thread_socket_send( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    ezbus_thread_t* thread = (ezbus_thread_t*)arg;
+    ezbus_thread_record_t* record = (ezbus_thread_record_t*)ezbus_ring_peek( &thread->tx_ring );
+
+    if ( record != NULL && record->op == ezbus_thread_op_send && ( socket == EZBUS_SOCKET_ANY || socket == record->socket ) )
+    {
+        int sent = ezbus_socket_send( mac, record->socket, &record->data[ record->offset ], record->size - record->offset );
+        if ( sent < 0 )
+        {
+            ++thread->tx_dropped;
+            ezbus_ring_release( &thread->tx_ring );
+            return false;
+        }
+        if ( sent > 0 )
+        {
+            record->offset += sent;
+            if ( record->offset >= record->size )
+            {
+                ezbus_ring_release( &thread->tx_ring );
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ezbus_thread_socket_recv( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    ezbus_thread_t* thread = (ezbus_thread_t*)arg;
+    size_t size = ezbus_socket_get_rx_size( mac, socket );
+    uint32_t need = size ? ( size + EZBUS_THREAD_RECORD_LN - 1 ) / EZBUS_THREAD_RECORD_LN : 1;
+    ezbus_thread_record_t* record;
+
+    if ( ezbus_ring_free( &thread->rx_ring ) < need )
+    {
+        /* not accepted, the peer will send it again, by which time the application may have caught up */
+        return false;
+    }
+
+    do
+    {
+        record = (ezbus_thread_record_t*)ezbus_ring_reserve( &thread->rx_ring );
+        record->op          = ezbus_thread_op_recv;
+        record->socket      = socket;
+        record->peer_socket = ezbus_socket_get_peer_socket( mac, socket );
+        record->tag         = 0;
+        ezbus_address_copy( &record->peer, ezbus_socket_get_peer_address( mac, socket ) );
+        record->size        = ezbus_socket_recv( mac, socket, record->data, EZBUS_THREAD_RECORD_LN );
+        size               -= record->size;
+        record->end         = ( size == 0 ) && ezbus_socket_recv_end( mac, socket );
+        ezbus_ring_commit( &thread->rx_ring );
+    } while ( size && record->size );
+
+    thread->posted = true;
+    return true;
+}
+
+static void ezbus_thread_socket_closing( ezbus_mac_t* mac, ezbus_socket_t socket, void* arg )
+{
+    ezbus_thread_post( (ezbus_thread_t*)arg, ezbus_thread_op_closed, socket, 0 );
+}
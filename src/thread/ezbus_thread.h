@@ -0,0 +1,190 @@
+/*****************************************************************************
+* Copyright © 2019-2020 Mike Sharkey <mike@8bitgeek.net>                     *
+*                                                                            *
+* Permission is hereby granted, free of charge, to any person obtaining a    *
+* copy of this software and associated documentation files (the "Software"), *
+* to deal in the Software without restriction, including without limitation  *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+* and/or sell copies of the Software, and to permit persons to whom the      *
+* Software is furnished to do so, subject to the following conditions:       *
+*                                                                            *
+* The above copyright notice and this permission notice shall be included in *
+* all copies or substantial portions of the Software.                        *
+*                                                                            *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        *
+* DEALINGS IN THE SOFTWARE.                                                  *
+*****************************************************************************/
+#ifndef EZBUS_THREAD_H_
+#define EZBUS_THREAD_H_
+
+/**
+ * @page thread Threaded Runtime
+ * An optional runtime which gives each @ref ezbus_t a thread of its own, such that a multi-core
+ * host can drive many bus segments in parallel. The bus thread is the only thread to touch
+ * mac and socket state. Application threads exchange records with it through a pair of 
+ * lock-free single-producer/single-consumer rings, see @ref ezbus_ring_t, one ring toward 
+ * the bus and one from it, so no lock is taken on either side.
+ * 
+ * The host creates the thread, and may pin it to a core, and runs @ref ezbus_thread_main() 
+ * on it. On Linux for example:\n
+ * \n
+ *    static void* bus_main( void* arg )\n
+ *    {\n
+ *        @ref ezbus_thread_main( (ezbus_thread_t*)arg );\n
+ *        return NULL;\n
+ *    }\n
+ *    \n
+ *    @ref ezbus_init( &ezbus, &port );\n
+ *    @ref ezbus_thread_init( &thread, &ezbus );\n
+ *    pthread_create( &tid, NULL, bus_main, &thread );\n
+ *    CPU_SET( core, &cpus );\n
+ *    pthread_setaffinity_np( tid, sizeof(cpus), &cpus );\n
+ * \n
+ * Exactly one application thread may post to a given @ref ezbus_thread_t, 
+ * (@ref ezbus_thread_open(), @ref ezbus_thread_send(), @ref ezbus_thread_close()), and exactly 
+ * one may take events from it (@ref ezbus_thread_peek(), @ref ezbus_thread_release()). 
+ * They may be the same thread.
+ */
+
+#include <ezbus.h>
+#include <ezbus_ring.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    /* application to bus */
+    ezbus_thread_op_open=0,         /* open a socket to peer:peer_socket, answered by ezbus_thread_op_opened */
+    ezbus_thread_op_send,           /* send data on socket */
+    ezbus_thread_op_close,          /* close socket */
+    /* bus to application */
+    ezbus_thread_op_opened,         /* the socket opened for tag, EZBUS_SOCKET_INVALID on failure */
+    ezbus_thread_op_recv,           /* data arrived on socket from peer:peer_socket */
+    ezbus_thread_op_closed,         /* the socket has closed */
+} ezbus_thread_op_t;
+
+typedef struct _ezbus_thread_record_t
+{
+    ezbus_thread_op_t   op;
+    ezbus_socket_t      socket;
+    ezbus_socket_t      peer_socket;
+    ezbus_address_t     peer;
+    bool                end;        /* recv, the data completes a message */
+    uint32_t            tag;        /* open/opened, chosen by the application */
+    size_t              offset;     /* send, bytes already taken by the socket */
+    size_t              size;
+    uint8_t             data[EZBUS_THREAD_RECORD_LN];
+} ezbus_thread_record_t;
+
+typedef struct _ezbus_thread_t ezbus_thread_t;
+
+/**
+ * @brief Block the bus thread for up to ms milli-seconds (EZBUS_TIMER_FOREVER for no limit),
+ *          or until the wake callback is invoked, or bytes arrive at the port.
+ */
+typedef void (*ezbus_thread_idle_callback_t) ( ezbus_thread_t* thread, ezbus_ms_tick_t ms, void* arg );
+
+/**
+ * @brief Signal a thread blocked in the matching idle or wait.
+ */
+typedef void (*ezbus_thread_wake_callback_t) ( ezbus_thread_t* thread, void* arg );
+
+struct _ezbus_thread_t
+{
+    ezbus_t*                        ezbus;
+    ezbus_ring_t                    tx_ring;        /* application to bus */
+    ezbus_ring_t                    rx_ring;        /* bus to application */
+    ezbus_thread_record_t           tx_records[EZBUS_THREAD_RING_LN];
+    ezbus_thread_record_t           rx_records[EZBUS_THREAD_RING_LN];
+    ezbus_thread_idle_callback_t    callback_idle;
+    ezbus_thread_wake_callback_t    callback_wake;  /* from application, interrupts callback_idle */
+    void*                           idle_arg;
+    ezbus_thread_wake_callback_t    callback_notify;/* from bus, events have been posted */
+    void*                           notify_arg;
+    bool                            stop;
+    bool                            posted;         /* events posted since the last notify */
+    uint32_t                        tx_dropped;     /* sends for sockets which had closed */
+    uint32_t                        rx_dropped;     /* events lost to a full ring */
+};
+
+/**
+ * @brief Initialize the runtime for an @ref ezbus_t which has been through @ref ezbus_init().
+ *          Takes over the socket callbacks of its mac, see @ref ezbus_socket_init().
+ */
+extern void             ezbus_thread_init               ( ezbus_thread_t* thread, ezbus_t* ezbus );
+
+/**
+ * @brief Without an idle callback the bus thread spins. With one, it sleeps whenever 
+ *          @ref ezbus_next_wakeup() allows, and callback_wake is invoked by application 
+ *          threads after posting, and by @ref ezbus_thread_stop(). A wake which comes before the
+ *          idle must not be lost, for instance poll() and write() on an eventfd, which may also be
+ *          handed to @ref ezbus_port_set_wake_callback().
+ */
+extern void             ezbus_thread_set_idle_callback  ( 
+                                                          ezbus_thread_t*              thread, 
+                                                          ezbus_thread_idle_callback_t callback_idle,
+                                                          ezbus_thread_wake_callback_t callback_wake,
+                                                          void*                        arg
+                                                        );
+
+/**
+ * @brief Invoked on the bus thread after it has posted events for the application.
+ */
+extern void             ezbus_thread_set_notify_callback( ezbus_thread_t* thread, ezbus_thread_wake_callback_t callback_notify, void* arg );
+
+/**
+ * @brief The bus thread body, runs @ref ezbus_thread_run() until @ref ezbus_thread_stop().
+ */
+extern void             ezbus_thread_main               ( ezbus_thread_t* thread );
+
+/**
+ * @brief One pass of the bus thread, for hosts which schedule it themselves.
+ * @return As @ref ezbus_next_wakeup().
+ */
+extern ezbus_ms_tick_t  ezbus_thread_run                ( ezbus_thread_t* thread );
+
+/**
+ * @brief Ask @ref ezbus_thread_main() to return. May be invoked from any thread.
+ */
+extern void             ezbus_thread_stop               ( ezbus_thread_t* thread );
+
+/**
+ * @brief Application, request a socket to a peer. The result arrives as ezbus_thread_op_opened 
+ *          carrying the same tag.
+ * @return false when the ring toward the bus is full.
+ */
+extern bool             ezbus_thread_open               ( ezbus_thread_t* thread, ezbus_address_t* peer, ezbus_socket_t peer_socket, uint32_t tag );
+
+/**
+ * @brief Application, queue a message of up to @ref EZBUS_THREAD_RECORD_LN bytes on a socket.
+ *          Messages larger than @ref EZBUS_PARCEL_DATA_LN are chained by the socket.
+ * @return false when the ring toward the bus is full, or size is too large.
+ */
+extern bool             ezbus_thread_send               ( ezbus_thread_t* thread, ezbus_socket_t socket, void* data, size_t size );
+
+/**
+ * @brief Application, close a socket. ezbus_thread_op_closed follows.
+ * @return false when the ring toward the bus is full.
+ */
+extern bool             ezbus_thread_close              ( ezbus_thread_t* thread, ezbus_socket_t socket );
+
+/**
+ * @brief Application, the oldest event from the bus, or NULL. The record stays valid until
+ *          @ref ezbus_thread_release(). A received message larger than @ref EZBUS_THREAD_RECORD_LN 
+ *          arrives as consecutive recv events, the last having `end` set.
+ */
+extern ezbus_thread_record_t* ezbus_thread_peek         ( ezbus_thread_t* thread );
+extern void             ezbus_thread_release            ( ezbus_thread_t* thread );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EZBUS_THREAD_H_ */